@@ -0,0 +1,373 @@
+//map/unmap/remap/sync/flush throughput + latency under multi-threaded load - host memory, memcpy transfer devices
+//g++ -std=c++17 -O2 -pthread benchmark.cpp -o benchmark (add -D__DG_TLB_STATS__ for the hot-path counters)
+//./benchmark --threads 8 --virtual_pages 256 --physical_pages 64 --pattern zipf --ops 200000 > bench.json
+
+#include "dg_tlb.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace bench{
+
+    using namespace dg::flush_on_cap_tlb;
+
+    enum class Pattern{
+        uniform,
+        zipf,
+        sequential,
+        strided,
+        hot_set_shift
+    };
+
+    struct Option{
+        size_t thread_count             = 4u;
+        size_t virtual_page_count       = 256u;
+        size_t physical_page_count      = 64u;
+        size_t page_sz                  = PAGE_SZ;
+        size_t op_count                 = 100000u; //per thread
+        Pattern pattern                 = Pattern::uniform;
+        EvictionPolicy eviction_policy  = EvictionPolicy::clock;
+        bool thread_cache_enabled       = false;
+        size_t stride                   = 7u; //pages, strided pattern
+        double zipf_theta               = 0.99;
+        double write_ratio              = 0.5;
+        size_t hot_set_page_count       = 16u;
+        size_t hot_set_shift_op_count   = 10000u; //per thread ops between hot set shifts
+        size_t sync_interval            = 0u; //per thread ops between sync() invokes of thread 0, 0 disables
+        size_t seed                     = 1u;
+    };
+
+    struct DeviceCounter{
+        std::atomic<size_t> fill_count{};
+        std::atomic<size_t> fill_byte{};
+        std::atomic<size_t> write_back_count{};
+        std::atomic<size_t> write_back_byte{};
+    };
+
+    static inline DeviceCounter device_counter{};
+
+    #if defined(__DG_TLB_STATS__)
+    static inline constexpr bool IS_STATS_ENABLED = true;
+    #else
+    static inline constexpr bool IS_STATS_ENABLED = false;
+    #endif
+
+    void fill_device(void * dst, const void * src, size_t sz) noexcept{
+
+        memcpy(dst, src, sz);
+        device_counter.fill_count.fetch_add(1u, std::memory_order_relaxed);
+        device_counter.fill_byte.fetch_add(sz, std::memory_order_relaxed);
+    }
+
+    void write_back_device(void * dst, const void * src, size_t sz) noexcept{
+
+        memcpy(dst, src, sz);
+        device_counter.write_back_count.fetch_add(1u, std::memory_order_relaxed);
+        device_counter.write_back_byte.fetch_add(sz, std::memory_order_relaxed);
+    }
+
+    //cdf over rank, rank 0 is the hottest page. pages are shuffled so the hot ones are spread over the translator
+    class ZipfGenerator{
+
+        private:
+
+            std::vector<double> cdf;
+            std::vector<size_t> rank_to_page;
+
+        public:
+
+            ZipfGenerator(size_t page_count, double theta, size_t seed): cdf(page_count), rank_to_page(page_count){
+
+                double sum = 0;
+
+                for (size_t i = 0; i < page_count; ++i){
+                    sum     += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+                    cdf[i]  = sum;
+                }
+
+                for (size_t i = 0; i < page_count; ++i){
+                    cdf[i] /= sum;
+                    rank_to_page[i] = i;
+                }
+
+                std::shuffle(rank_to_page.begin(), rank_to_page.end(), std::mt19937_64(seed));
+            }
+
+            template <class Rng>
+            auto next(Rng& rng) const -> size_t{
+
+                double u    = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+                size_t rank = std::distance(cdf.begin(), std::lower_bound(cdf.begin(), cdf.end(), u));
+
+                return rank_to_page[std::min(rank, cdf.size() - 1)];
+            }
+    };
+
+    struct ThreadResult{
+        std::vector<uint32_t> map_latency_list; //ns, saturated
+        size_t op_count         = 0u;
+        size_t no_page_found    = 0u;
+    };
+
+    auto parse_pattern(const std::string& arg) -> Pattern{
+
+        if (arg == "uniform")       return Pattern::uniform;
+        if (arg == "zipf")          return Pattern::zipf;
+        if (arg == "sequential")    return Pattern::sequential;
+        if (arg == "strided")       return Pattern::strided;
+        if (arg == "hot_set_shift") return Pattern::hot_set_shift;
+
+        fprintf(stderr, "unknown pattern %s\n", arg.c_str());
+        std::exit(1);
+    }
+
+    auto pattern_name(Pattern pattern) -> const char *{
+
+        switch (pattern){
+            case Pattern::uniform:          return "uniform";
+            case Pattern::zipf:             return "zipf";
+            case Pattern::sequential:       return "sequential";
+            case Pattern::strided:          return "strided";
+            case Pattern::hot_set_shift:    return "hot_set_shift";
+        }
+
+        return "";
+    }
+
+    auto parse_policy(const std::string& arg) -> EvictionPolicy{
+
+        if (arg == "flush_zero_ref")    return EvictionPolicy::flush_zero_ref;
+        if (arg == "clock")             return EvictionPolicy::clock;
+        if (arg == "clock_cold_insert") return EvictionPolicy::clock_cold_insert;
+
+        fprintf(stderr, "unknown eviction policy %s\n", arg.c_str());
+        std::exit(1);
+    }
+
+    auto policy_name(EvictionPolicy policy) -> const char *{
+
+        switch (policy){
+            case EvictionPolicy::flush_zero_ref:    return "flush_zero_ref";
+            case EvictionPolicy::clock:             return "clock";
+            case EvictionPolicy::clock_cold_insert: return "clock_cold_insert";
+        }
+
+        return "";
+    }
+
+    auto parse_option(int argc, char ** argv) -> Option{
+
+        Option option{};
+
+        for (int i = 1; i + 1 < argc; i += 2){
+            std::string key = argv[i];
+            std::string val = argv[i + 1];
+
+            if (key == "--threads")                     option.thread_count = std::stoull(val);
+            else if (key == "--virtual_pages")          option.virtual_page_count = std::stoull(val);
+            else if (key == "--physical_pages")         option.physical_page_count = std::stoull(val);
+            else if (key == "--page_sz")                option.page_sz = std::stoull(val);
+            else if (key == "--ops")                    option.op_count = std::stoull(val);
+            else if (key == "--pattern")                option.pattern = parse_pattern(val);
+            else if (key == "--policy")                 option.eviction_policy = parse_policy(val);
+            else if (key == "--thread_cache")           option.thread_cache_enabled = std::stoull(val) != 0u;
+            else if (key == "--stride")                 option.stride = std::stoull(val);
+            else if (key == "--zipf_theta")             option.zipf_theta = std::stod(val);
+            else if (key == "--write_ratio")            option.write_ratio = std::stod(val);
+            else if (key == "--hot_set_pages")          option.hot_set_page_count = std::stoull(val);
+            else if (key == "--hot_set_shift_ops")      option.hot_set_shift_op_count = std::stoull(val);
+            else if (key == "--sync_interval")          option.sync_interval = std::stoull(val);
+            else if (key == "--seed")                   option.seed = std::stoull(val);
+            else{
+                fprintf(stderr, "unknown option %s\n", key.c_str());
+                std::exit(1);
+            }
+        }
+
+        return option;
+    }
+
+    auto now() noexcept -> std::chrono::steady_clock::time_point{
+
+        return std::chrono::steady_clock::now();
+    }
+
+    auto elapsed_ns(std::chrono::steady_clock::time_point first, std::chrono::steady_clock::time_point last) noexcept -> size_t{
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(last - first).count();
+    }
+
+    //sequential + strided walk the translator with remap, one page (sequential) or stride pages (strided) per op - every op maps the next page of the walk, so the hit rate is the share of walked pages still linked
+    void run_thread(const Option& option, char * translator, const ZipfGenerator& zipf, size_t thread_idx, ThreadResult& result){
+
+        std::mt19937_64 rng(option.seed * 1000003u + thread_idx);
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        std::uniform_int_distribution<size_t> uniform_page(0u, option.virtual_page_count - 1);
+        size_t walk_step    = option.pattern == Pattern::strided ? option.stride * option.page_sz : option.page_sz;
+        size_t walk_sz      = option.virtual_page_count * option.page_sz;
+        size_t walk_offs    = (thread_idx * option.virtual_page_count / option.thread_count) * option.page_sz;
+        char * walk_ptr     = nullptr;
+        char * walk_mapped  = nullptr;
+        result.map_latency_list.reserve(option.op_count);
+
+        auto record = [&](size_t ns){
+            result.map_latency_list.push_back(static_cast<uint32_t>(std::min(ns, size_t{UINT32_MAX})));
+        };
+
+        for (size_t i = 0; i < option.op_count; ++i){
+            if (option.sync_interval != 0u && thread_idx == 0u && i % option.sync_interval == option.sync_interval - 1){
+                dg::flush_on_cap_tlb::sync(); //qualified - ::sync (unistd.h) is visible through <atomic> in C++20
+            }
+
+            bool is_write = coin(rng) < option.write_ratio;
+
+            try{
+                if (option.pattern == Pattern::sequential || option.pattern == Pattern::strided){
+                    char * nxt_ptr = translator + walk_offs;
+                    auto first     = now();
+                    walk_mapped    = static_cast<char *>(walk_ptr ? remap(walk_ptr, walk_mapped, nxt_ptr) : map(nxt_ptr));
+                    record(elapsed_ns(first, now()));
+                    walk_ptr       = nxt_ptr;
+                    walk_offs      = (walk_offs + walk_step) % walk_sz;
+
+                    if (is_write){
+                        __atomic_fetch_add(walk_mapped, char{1}, __ATOMIC_RELAXED); //threads may share the byte
+                    } else{
+                        asm volatile("" :: "r"(walk_mapped[0]));
+                    }
+                } else{
+                    size_t page = 0u;
+
+                    if (option.pattern == Pattern::uniform){
+                        page = uniform_page(rng);
+                    } else if (option.pattern == Pattern::zipf){
+                        page = zipf.next(rng);
+                    } else{
+                        size_t phase = i / option.hot_set_shift_op_count;
+                        page = coin(rng) < 0.9 ? (phase * option.hot_set_page_count + rng() % option.hot_set_page_count) % option.virtual_page_count : uniform_page(rng);
+                    }
+
+                    char * ptr  = translator + page * option.page_sz + (rng() % (option.page_sz / 64u)) * 64u;
+                    auto first  = now();
+                    char * mapped = static_cast<char *>(is_write ? map(ptr) : map_readonly(ptr));
+                    record(elapsed_ns(first, now()));
+
+                    if (is_write){
+                        __atomic_fetch_add(mapped, char{1}, __ATOMIC_RELAXED);
+                    } else{
+                        asm volatile("" :: "r"(mapped[0]));
+                    }
+
+                    unmap(ptr);
+                }
+
+                result.op_count += 1;
+            } catch (no_page_found&){
+                result.no_page_found += 1;
+            }
+        }
+
+        if (walk_ptr){
+            unmap(walk_ptr);
+        }
+    }
+
+    auto percentile(const std::vector<uint32_t>& sorted_list, double p) -> size_t{
+
+        if (sorted_list.empty()){
+            return 0u;
+        }
+
+        return sorted_list[std::min(static_cast<size_t>(p * sorted_list.size()), sorted_list.size() - 1)];
+    }
+}
+
+int main(int argc, char ** argv){
+
+    using namespace bench;
+
+    Option option       = parse_option(argc, argv);
+    size_t translator_sz = option.virtual_page_count * option.page_sz;
+    size_t translatee_sz = option.physical_page_count * option.page_sz;
+    char * translator   = static_cast<char *>(aligned_alloc(option.page_sz, translator_sz));
+    char * translatee   = static_cast<char *>(aligned_alloc(option.page_sz, translatee_sz));
+
+    if (!translator || !translatee){
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    memset(translator, 0, translator_sz);
+    memset(translatee, 0, translatee_sz);
+
+    Config config{};
+    config.translator_addr                      = translator;
+    config.translator_sz                        = translator_sz;
+    config.translatee_addr                      = translatee;
+    config.translatee_sz                        = translatee_sz;
+    config.virtual_to_physical_transfer_device  = fill_device;
+    config.physical_to_virtual_transfer_device  = write_back_device;
+    config.eviction_policy                      = option.eviction_policy;
+    config.thread_cache_enabled                 = option.thread_cache_enabled;
+    config.page_sz                              = option.page_sz;
+    init(config);
+
+    ZipfGenerator zipf(option.virtual_page_count, option.zipf_theta, option.seed);
+    std::vector<ThreadResult> result_list(option.thread_count);
+    std::vector<std::thread> thread_list;
+    auto first = now();
+
+    for (size_t i = 0; i < option.thread_count; ++i){
+        thread_list.emplace_back(run_thread, std::cref(option), translator, std::cref(zipf), i, std::ref(result_list[i]));
+    }
+
+    for (auto& thread: thread_list){
+        thread.join();
+    }
+
+    size_t run_ns   = elapsed_ns(first, now());
+    auto flush_first = now();
+    flush();
+    size_t flush_ns = elapsed_ns(flush_first, now());
+    Stats stat      = stats();
+
+    std::vector<uint32_t> latency_list;
+    size_t op_count         = 0u;
+    size_t no_page_found    = 0u;
+
+    for (auto& result: result_list){
+        latency_list.insert(latency_list.end(), result.map_latency_list.begin(), result.map_latency_list.end());
+        op_count        += result.op_count;
+        no_page_found   += result.no_page_found;
+    }
+
+    std::sort(latency_list.begin(), latency_list.end());
+    size_t fill_count   = device_counter.fill_count.load();
+    double hit_rate     = op_count == 0u ? 0.0 : 1.0 - std::min(1.0, static_cast<double>(fill_count) / static_cast<double>(op_count)); //every miss is one fill - no prefetch here
+
+    printf("{\"pattern\": \"%s\", \"policy\": \"%s\", \"thread_cache\": %s, \"threads\": %zu, \"virtual_pages\": %zu, \"physical_pages\": %zu, \"page_sz\": %zu, \"ops\": %zu, \"no_page_found\": %zu, ",
+           pattern_name(option.pattern), policy_name(option.eviction_policy), option.thread_cache_enabled ? "true" : "false", option.thread_count, option.virtual_page_count, option.physical_page_count, option.page_sz, op_count, no_page_found);
+    printf("\"ops_per_sec\": %.1f, \"map_ns_p50\": %zu, \"map_ns_p99\": %zu, \"map_ns_p999\": %zu, \"hit_rate\": %.6f, ",
+           static_cast<double>(op_count) * 1e9 / static_cast<double>(std::max(run_ns, size_t{1u})), percentile(latency_list, 0.5), percentile(latency_list, 0.99), percentile(latency_list, 0.999), hit_rate);
+    printf("\"fill_count\": %zu, \"fill_byte\": %zu, \"write_back_count\": %zu, \"write_back_byte\": %zu, \"flush_ns\": %zu, ",
+           fill_count, device_counter.fill_byte.load(), device_counter.write_back_count.load(), device_counter.write_back_byte.load(), flush_ns);
+    if (!IS_STATS_ENABLED){ //stats() snapshots are zero - not measured, not zero
+        printf("\"stats_enabled\": false, \"stats\": null}\n");
+    } else{
+        printf("\"stats_enabled\": true, \"stats\": {\"map_hit\": %zu, \"map_miss\": %zu, \"thread_cache_hit\": %zu, \"map_cas_retry\": %zu, \"dec_ref_cas_retry\": %zu, \"clock_evict\": %zu, \"no_page_found\": %zu}}\n",
+               stat.get(Stat::map_hit), stat.get(Stat::map_miss), stat.get(Stat::thread_cache_hit), stat.get(Stat::map_cas_retry), stat.get(Stat::dec_ref_cas_retry), stat.get(Stat::clock_evict), stat.get(Stat::no_page_found));
+    }
+
+    deinit();
+    free(translator);
+    free(translatee);
+
+    return 0;
+}
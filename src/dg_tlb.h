@@ -4,6 +4,7 @@
 #include <vector>
 #include <stdint.h>
 #include <stdlib.h>
+#include <cstdlib>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -11,20 +12,151 @@
 #include <atomic>
 #include <optional>
 #include <iterator>
+#include <climits>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <new>
+#include <chrono>
+#include <utility>
+#include <tuple>
+#include <exception>
+#include <cstring>
+#include <list>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#endif
+#endif
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 
 namespace dg::flush_on_cap_tlb{
     
     using virtual_page_state_t                                                  = size_t; 
-    static inline constexpr size_t PAGE_SZ                                      = size_t{1} << 20;
+    static inline constexpr size_t PAGE_SZ                                      = size_t{1} << 20; //default page size, per instance otherwise (Config::page_sz)
+    static inline constexpr size_t MIN_PAGE_SZ                                  = size_t{1} << 6;
     static inline constexpr size_t CACHE_LINE_SIZE                              = size_t{1} << 6; 
     static inline constexpr virtual_page_state_t virtual_page_null_state        = 0u;
     static inline constexpr virtual_page_state_t virtual_page_transfer_state    = ~virtual_page_null_state; //single ownership (test_and_set-liked property), denotes buffer transfering 
-    static inline constexpr size_t ID_BITCOUNT                                  = sizeof(uint16_t) * CHAR_BIT;
-    static inline constexpr size_t REF_BITCOUNT                                 = sizeof(uint16_t) * CHAR_BIT; 
-
-    static_assert(ID_BITCOUNT + REF_BITCOUNT <= sizeof(virtual_page_state_t) * CHAR_BIT);
+    static inline constexpr size_t ID_BITCOUNT                                  = sizeof(uint32_t) * CHAR_BIT; //physical_page_idx + 1
+    static inline constexpr size_t REF_BITCOUNT                                 = 28u; 
+    static inline constexpr size_t FLAG_BITCOUNT                                = 4u; //page flags, sit between counter and idx - so counter arithmetic does not spill into flags
+    static inline constexpr size_t VIRTUAL_PAGE_MAX_REF                         = (size_t{1} << REF_BITCOUNT) - 2u; //a full counter is never reached - a valid page_state is never transfer_state
+    static inline constexpr virtual_page_state_t virtual_page_referenced_flag   = virtual_page_state_t{1} << REF_BITCOUNT; //CLOCK reference bit, set on map - cleared by the sweeping hand
+    static inline constexpr virtual_page_state_t virtual_page_dirty_flag        = virtual_page_state_t{1} << (REF_BITCOUNT + 1); //set by writable map, cleared by write back - clean pages are unlinked without transfer
+    static inline constexpr virtual_page_state_t virtual_page_loading_state     = virtual_page_transfer_state & ~(virtual_page_state_t{1} << (REF_BITCOUNT + FLAG_BITCOUNT - 1)); //transfer_state of a link (fill in flight) - full counter, never a valid page_state
+    static inline constexpr size_t FREE_LIST_SHARD_COUNT                        = 16u;
+    static inline constexpr size_t MAX_NUMA_NODE_COUNT                          = FREE_LIST_SHARD_COUNT; //every node owns at least one free list shard
+    static inline constexpr size_t NUMA_NODE_REFRESH_INTERVAL                   = 1024u; //acquisitions between two getcpu of a thread - threads rarely migrate between nodes
+    static inline constexpr size_t FREE_LIST_LINK_BITCOUNT                      = sizeof(uint32_t) * CHAR_BIT; //physical_page_idx + 1 of the head, the remaining bits are the ABA tag 
+    static inline constexpr size_t THREAD_CACHE_SZ                              = 64u; //direct-mapped, must be pow2
+    static inline constexpr size_t THREAD_CACHE_PIN_BITCOUNT                    = sizeof(uint16_t) * CHAR_BIT;
+    static inline constexpr size_t DIRTY_CHUNK_BITMAP_WORD_BITCOUNT             = sizeof(uint64_t) * CHAR_BIT;
+    static inline constexpr size_t TRANSFER_BATCH_PAGE_SZ                       = 64u; //max pages held in transfer_state by a batched write back
+    static inline constexpr size_t TRANSFER_BATCH_DESCRIPTOR_SZ                 = 256u; //descriptors per submit - a full batch is submitted + waited before more are queued
+    static inline constexpr size_t THREAD_POOL_TRANSFER_SPLIT_SZ                = size_t{1} << 18; //descriptors are split into jobs of at most this size, so a single page is copied by several workers
+    static inline constexpr size_t VIRTUAL_PAGE_STATE_BLOCK_SHIFT               = 3u; 
+    static inline constexpr size_t VIRTUAL_PAGE_STATE_PER_BLOCK                 = size_t{1} << VIRTUAL_PAGE_STATE_BLOCK_SHIFT; //states per cache line of a packed page table
+    static inline constexpr size_t LINKED_BITMAP_WORD_BITCOUNT                  = sizeof(uint64_t) * CHAR_BIT;
+    static inline constexpr size_t VIRTUAL_PAGE_LEAF_BLOCK_SHIFT                = 9u; //a directory leaf is 512 state blocks (32KiB) - 512 padded or 4096 packed virtual pages
+    static inline constexpr size_t VIRTUAL_PAGE_LEAF_BLOCK_COUNT                = size_t{1} << VIRTUAL_PAGE_LEAF_BLOCK_SHIFT;
+    static inline constexpr size_t WRITE_BACK_PARTITION_SZ                      = 1024u; //virtual pages pulled at once by a parallel sync_all/drop_all worker
+    static inline constexpr size_t WAIT_PAUSE_ROUND                             = 7u; //backoff rounds of 1, 2, 4 .. 64 pauses
+    static inline constexpr size_t WAIT_YIELD_ROUND                             = 4u; //backoff rounds of yield after the pause rounds, then park (transfer_state) or sleep
+    static inline constexpr size_t WAIT_SLEEP_US                                = 50u;
+    static inline constexpr size_t TRANSFER_WAITER_SHARD_COUNT                  = 16u;
+    static inline constexpr size_t VICTIM_TIER_SHARD_COUNT                      = 16u;
+    static inline constexpr size_t VICTIM_TIER_ENTRY_OVERHEAD_SZ                = 64u; //bytes charged per entry on top of the payload - bounds the entry count of zero pages
+    static inline constexpr size_t VICTIM_TIER_MIN_RUN                          = 8u; //shorter runs are kept as literals
+    static inline constexpr size_t VICTIM_TIER_MIN_RATIO                        = 2u; //a page is stored only if it compresses to page_sz / VICTIM_TIER_MIN_RATIO or less
+    static inline constexpr size_t VICTIM_TIER_PROBE_SZ                         = size_t{1} << 12; //prefix compressed first - incompressible pages are rejected without a full scan
+    static inline constexpr size_t TRACE_SHARD_COUNT                            = 16u;
+    static inline constexpr size_t TRACE_BUFFER_RECORD_COUNT                    = size_t{1} << 12; //records buffered per shard - the sink is invoked once a shard buffer is full
+    static inline constexpr uint64_t TRACE_MAGIC                                = 0x315254424C544744u; //"DGTLBTR1"
+    static inline constexpr uint64_t TRACE_VERSION                              = 2u; //2 - TraceHeader carries the engine options after eviction_policy
+
+    static_assert((THREAD_CACHE_SZ & (THREAD_CACHE_SZ - 1)) == 0u);
+
+    static_assert(ID_BITCOUNT + FLAG_BITCOUNT + REF_BITCOUNT <= sizeof(virtual_page_state_t) * CHAR_BIT);
+    static_assert(FREE_LIST_LINK_BITCOUNT <= ID_BITCOUNT); //every physical_page_idx + 1 that fits a free list link fits a page_state
 
     using mem_transfer_device_t = void (*) (void *, const void *, size_t) noexcept;  
+    using transfer_token_t      = size_t;
+
+    struct TransferDescriptor{
+        void * dst;
+        const void * src;
+        size_t sz;
+    };
+
+    //submit queues a batch of descriptors and returns without waiting for the copies, wait blocks until every descriptor of the token is transferred (memory-deduced-qualified)
+    //a token must be waited exactly once. submit == nullptr denotes no async device - the synchronous mem_transfer_device_t is used
+    struct AsyncTransferDevice{
+        void * ctx;
+        transfer_token_t (*submit)(void * ctx, const TransferDescriptor * descriptor_list, size_t descriptor_sz) noexcept;
+        void (*wait)(void * ctx, transfer_token_t token) noexcept;
+    };
+
+    enum class TraceOp: uint8_t{
+        map,            //map, map_write, map_ref, map_range (one per page), map_batch (one per pointer), co_map
+        map_readonly,   //readonly variants of map
+        unmap,          //unmap, unmap_batch (one per pointer), PageRef + MappedRange release (one per page)
+        shootdown,
+        sync,           //sync(ptr), co_sync
+        sync_all,       //sync(), sync(executor, max_concurrency)
+        flush           //flush(), flush(executor, max_concurrency)
+    };
+
+    //one recorded call - written out as is (no padding, little endian on every supported target)
+    struct TraceRecord{
+        uint64_t timestamp; //ns since trace_start
+        uint64_t offs; //byte offset of the ptr in the translator, 0 for sync_all + flush
+        uint32_t sz; //bytes written through the mapping starting at ptr (map_write, map_range) - page_sz for map, 0 otherwise
+        uint16_t thread_id; //process-wide id of the calling thread, truncated
+        uint8_t op; //TraceOp
+        uint8_t reserved;
+    };
+
+    //handed to the sink once per trace_start - describes the table the records refer to
+    struct TraceHeader{
+        uint64_t magic; //TRACE_MAGIC
+        uint64_t version; //TRACE_VERSION
+        uint64_t page_sz;
+        uint64_t translator_sz;
+        uint64_t translatee_sz;
+        uint64_t eviction_policy; //EvictionPolicy
+        uint64_t thread_cache_enabled; //0 or 1
+        uint64_t dirty_chunk_sz;
+        uint64_t readahead_page_count;
+        uint64_t page_table_layout; //PageTableLayout
+        uint64_t victim_tier_sz;
+        uint64_t numa_node_count;
+    };
+
+    static_assert(sizeof(TraceRecord) == 24u);
+    static_assert(sizeof(TraceHeader) == 96u);
+
+    //header is invoked by trace_start before any record, write with a full shard buffer (or the remainder on trace_stop). write is invoked by several threads at once (one per shard) - never after trace_stop returned
+    struct TraceSink{
+        void * ctx;
+        void (*header)(void * ctx, const TraceHeader& header) noexcept;
+        void (*write)(void * ctx, const TraceRecord * record_list, size_t record_sz) noexcept;
+    };
+
+    using executor_task_t = void (*)(void *) noexcept;
+
+    //post runs task(arg) on another thread at some point, false if the task could not be queued (the caller keeps the ownership of arg). post == nullptr denotes no executor - tasks run on the calling thread
+    struct Executor{
+        void * ctx;
+        bool (*post)(void * ctx, executor_task_t task, void * arg) noexcept;
+    };
 
     #if defined(__IS_CUDA__)
 
@@ -76,6 +208,31 @@ namespace dg::flush_on_cap_tlb{
         return atomicSub(&obj, val);
     }
 
+    __device__ inline auto dg_atomic_fetch_or(unsigned int& obj, unsigned int val, const std::memory_order) noexcept -> unsigned int{
+
+        return atomicOr(&obj, val);
+    }
+
+    __device__ inline auto dg_atomic_fetch_or(unsigned long long int& obj, unsigned long long int val, const std::memory_order) noexcept -> unsigned long long int{
+
+        return atomicOr(&obj, val);
+    }
+
+    __device__ inline auto dg_atomic_fetch_and(unsigned int& obj, unsigned int val, const std::memory_order) noexcept -> unsigned int{
+
+        return atomicAnd(&obj, val);
+    }
+
+    __device__ inline auto dg_atomic_fetch_and(unsigned long long int& obj, unsigned long long int val, const std::memory_order) noexcept -> unsigned long long int{
+
+        return atomicAnd(&obj, val);
+    }
+
+    __device__ inline auto countr_zero(unsigned long long int word) noexcept -> size_t{
+
+        return __ffsll(word) - 1;
+    }
+
     __device__ inline auto dg_atomic_flag_test_and_set(unsigned int& obj, const std::memory_order) noexcept -> unsigned int{
 
         return atomicExch(&obj, unsigned_int{1u}) == 0u; //cmp to 0u is faster due to nullptr optimization -
@@ -126,6 +283,18 @@ namespace dg::flush_on_cap_tlb{
         return atomicCAS(&obj, cmp, val) == cmp;
     }
 
+    template <class T, std::enable_if_t<std::is_fundamental_v<T> && sizeof(T) <= MAX_ATOMIC_LOAD_SIZE, bool> = true>
+    __device__ inline void dg_atomic_store(T& obj, T val, std::memory_order) noexcept{
+
+        obj = val;
+    }
+
+    template <class T>
+    __device__ inline void dg_atomic_wait(const T&, T, std::memory_order) noexcept{} //no parking on device - the caller spins
+
+    template <class T>
+    __device__ inline void dg_atomic_notify_all(T&) noexcept{}
+
     __device__ inline void dg_atomic_thread_fence(const std::memory_order mem_order) noexcept{
 
         (void) mem_order;
@@ -158,9 +327,27 @@ namespace dg::flush_on_cap_tlb{
         return obj.fetch_sub(val, mem_order);
     }
 
+    template <class T>
+    inline auto dg_atomic_fetch_or(std::atomic<T>& obj, T val, const std::memory_order mem_order) noexcept -> T{
+
+        return obj.fetch_or(val, mem_order);
+    }
+
+    template <class T>
+    inline auto dg_atomic_fetch_and(std::atomic<T>& obj, T val, const std::memory_order mem_order) noexcept -> T{
+
+        return obj.fetch_and(val, mem_order);
+    }
+
+    //index of the lowest set bit - word != 0
+    inline auto countr_zero(uint64_t word) noexcept -> size_t{
+
+        return __builtin_ctzll(word);
+    }
+
     inline auto dg_atomic_flag_test_and_set(std::atomic_flag& obj, const std::memory_order mem_order) noexcept -> bool{
 
-        return obj.test_and_set(mem_order);
+        return !obj.test_and_set(mem_order); //true denotes acquisition (flag was clear), as the __IS_CUDA__ counterpart
     }
 
     inline void dg_atomic_flag_clear(std::atomic_flag& obj, const std::memory_order mem_order) noexcept{
@@ -180,6 +367,36 @@ namespace dg::flush_on_cap_tlb{
         return obj.compare_exchange_strong(cmp, val, mem_order);
     } 
 
+    template <class T>
+    inline void dg_atomic_store(std::atomic<T>& obj, T val, const std::memory_order mem_order) noexcept{
+
+        obj.store(val, mem_order);
+    }
+
+    //block until obj != old (spurious wakeups are allowed). sleeps WAIT_SLEEP_US if the library has no atomic wait (pre C++20)
+    template <class T>
+    inline void dg_atomic_wait(const std::atomic<T>& obj, T old, const std::memory_order mem_order) noexcept{
+
+        #if defined(__cpp_lib_atomic_wait)
+        obj.wait(old, mem_order);
+        #else
+        (void) obj;
+        (void) old;
+        (void) mem_order;
+        std::this_thread::sleep_for(std::chrono::microseconds(WAIT_SLEEP_US));
+        #endif
+    }
+
+    template <class T>
+    inline void dg_atomic_notify_all(std::atomic<T>& obj) noexcept{
+
+        #if defined(__cpp_lib_atomic_wait)
+        obj.notify_all();
+        #else
+        (void) obj;
+        #endif
+    }
+
     inline void dg_atomic_thread_fence(const std::memory_order mem_order) noexcept{
 
         std::atomic_thread_fence(mem_order);
@@ -188,37 +405,270 @@ namespace dg::flush_on_cap_tlb{
     #endif 
 
     struct no_page_found: std::exception{}; 
+    struct reference_overflow: std::exception{}; //a virtual page holds VIRTUAL_PAGE_MAX_REF references
+
+    //hot-path counters - only collected if __DG_TLB_STATS__ is defined, stats() snapshots are zero otherwise
+    enum class Stat: size_t{
+        map_hit,                    //virtual_page_try_map_n_inc_ref_if_exists mapped a linked page
+        map_miss,                   //virtual_page_try_link_n_inc_ref linked a page
+        thread_cache_hit,           //thread_cache_fetch_n_inc_ref served from the calling thread's cache
+        map_cas_retry,              //failed cmpexch + transfer_state spins in virtual_page_try_map_n_inc_ref_if_exists
+        link_claim_fail,            //virtual_page_try_link_n_inc_ref lost the null_state claim
+        link_coalesced,             //maps that waited for another thread's fill (loading_state) instead of transferring - not counted as map_hit
+        dec_ref_cas_retry,          //failed cmpexch + transfer_state spins in virtual_page_dec_ref
+        clock_evict,                //victims evicted by the CLOCK hand
+        release_zero_ref_fallback,  //flush_zero_ref sweeps on a miss
+        no_page_found,              //no_page_found thrown
+        fill_transfer,              //virtual_to_physical descriptors
+        fill_byte,                  //virtual_to_physical bytes
+        write_back_transfer,        //physical_to_virtual descriptors
+        write_back_byte,            //physical_to_virtual bytes
+        prefetch_link,              //pages linked by prefetch/readahead
+        readahead,                  //strided misses that triggered a readahead
+        victim_tier_hit,            //fills served from the victim tier (no virtual_to_physical transfer)
+        victim_tier_insert,         //evicted pages stored in the victim tier
+        numa_remote_acquire,        //physical pages handed to a thread running on another node than the page
+        virtual_page_leaf_alloc,    //virtual page table leaves allocated - only linking a page of an absent leaf allocates one
+        count
+    };
+
+    static inline constexpr size_t STAT_COUNT                       = static_cast<size_t>(Stat::count);
+    static inline constexpr size_t STAT_HISTOGRAM_BUCKET_COUNT      = sizeof(size_t) * CHAR_BIT; //bucket i counts misses served in [2^i, 2^(i + 1)) ns
+
+    struct Stats{
+        size_t counter_list[STAT_COUNT];
+        size_t miss_latency_histogram[STAT_HISTOGRAM_BUCKET_COUNT];
+        size_t numa_acquire_list[MAX_NUMA_NODE_COUNT]; //physical pages acquired (popped or evicted) from the partition of node i
+
+        auto get(Stat stat) const noexcept -> size_t{
+
+            return counter_list[static_cast<size_t>(stat)];
+        }
+    };
+
+    #if defined(__DG_TLB_STATS__)
+
+    //owned by one thread - plain load + store (no cmpexch), read by stat snapshots
+    struct StatBlock{
+        dg_atomic_type<size_t> counter_list[STAT_COUNT];
+        dg_atomic_type<size_t> miss_latency_histogram[STAT_HISTOGRAM_BUCKET_COUNT];
+        dg_atomic_type<size_t> numa_acquire_list[MAX_NUMA_NODE_COUNT];
+    };
+
+    //shared between a table and the stat blocks of the threads that touched it - outlives the table if threads still hold blocks
+    struct StatRegistry{
+        std::mutex mtx; //guards registration + snapshots, never taken on the hot path
+        std::vector<StatBlock *> block_list;
+        Stats retired; //folded blocks of exited threads
+    };
+
+    struct StatBlockOwner{
+        StatBlock block;
+        std::shared_ptr<StatRegistry> registry;
+    };
+
+    #endif
+
+    //flush_zero_ref writes back + unlinks every zero-ref page on a miss (legacy)
+    //clock evicts zero-ref pages one at a time - a referenced page gets a second chance 
+    //clock_cold_insert is clock without the reference bit on link - pages touched once (scans) are evicted before pages that are re-mapped
+    enum class EvictionPolicy{
+        flush_zero_ref,
+        clock,
+        clock_cold_insert
+    };
+
+    enum class PageTableLayout{
+        padded, //a cache line per virtual page - no false sharing between neighbouring pages
+        packed //8 bytes per virtual page - for huge translators, neighbouring pages share cache lines
+    };
 
+    //construction options of a TLB - the translator, the translatee and the transfer devices must be set, the other fields default
     struct Config{
-        void * translator_addr; //should be origined from char * (avoid UB - pointer arithmetic on std-qualified char array - whose pointer is obtained from new[] operation)
-        size_t translator_sz;
-        void * translatee_addr; //should be origined from char * (avoid UB - pointer arithmetic on std-qualified char array - whose pointer is obtained from new[] operation) 
-        size_t translatee_sz;
-        mem_transfer_device_t virtual_to_physical_transfer_device;
-        mem_transfer_device_t physical_to_virtual_transfer_device;
+        void * translator_addr = nullptr; //should be origined from char * (avoid UB - pointer arithmetic on std-qualified char array - whose pointer is obtained from new[] operation)
+        size_t translator_sz = 0u;
+        void * translatee_addr = nullptr; //should be origined from char * (avoid UB - pointer arithmetic on std-qualified char array - whose pointer is obtained from new[] operation) 
+        size_t translatee_sz = 0u;
+        mem_transfer_device_t virtual_to_physical_transfer_device = nullptr;
+        mem_transfer_device_t physical_to_virtual_transfer_device = nullptr;
+        EvictionPolicy eviction_policy = EvictionPolicy::clock;
+        bool thread_cache_enabled = false;
+        size_t dirty_chunk_sz = 0u; //write back granularity - 0 denotes whole page (no sub-page tracking), pow2 divisor of page_sz otherwise
+        AsyncTransferDevice virtual_to_physical_async_transfer_device = {}; //optional, overrides virtual_to_physical_transfer_device if submit != nullptr
+        AsyncTransferDevice physical_to_virtual_async_transfer_device = {}; //optional, overrides physical_to_virtual_transfer_device if submit != nullptr
+        size_t readahead_page_count = 0u; //pages prefetched ahead of a miss that continues a sequential/strided miss pattern - 0 disables the detector
+        Executor prefetch_executor = {}; //optional, prefetches run on the calling thread if post == nullptr
+        size_t page_sz = PAGE_SZ; //pow2 >= MIN_PAGE_SZ - the translator/translatee sizes + addresses are multiples of page_sz
+        PageTableLayout page_table_layout = PageTableLayout::padded;
+        size_t victim_tier_sz = 0u; //bytes of compressed evicted pages kept in memory - 0 disables the victim tier
+        size_t numa_node_count = 1u; //the translatee is split into numa_node_count contiguous partitions (see numa_partition_first), partition i is local to node i - 1 disables NUMA awareness
     };
 
     struct PhysicalPageState{
         alignas(CACHE_LINE_SIZE) void * addr; //immutable void * const  
-        alignas(CACHE_LINE_SIZE) dg_atomic_flag_type is_acquired; //true denotes linkage to at most 1 page, false denotes no linkage + mem-safe (addr is not referenced by any at-the-time variables)
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<size_t> next; //free-list linkage (next physical_page_idx + 1, 0 denotes end of list) - only meaningful while the page sits in a free list. being in a free list denotes no linkage + mem-safe (addr is not referenced by any at-the-time variables)
+        dg_atomic_type<size_t> virtual_page_idx; //last linker hint - only meaningful if the virtual page state at virtual_page_idx points back to this page
+    };
+
+    //tagged Treiber stack - head is (tag << FREE_LIST_LINK_BITCOUNT) | (physical_page_idx + 1), 0 link denotes empty. tag is bumped on every change (ABA)
+    struct FreeList{
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<uint64_t> head;
     };
 
     //rules:
     //null_state denotes no linkage to any physical page + virtual memory spanned by the page is up-to-date + mem-safe (addr is not referenced by any at-the-time variables). 
     //transfer_state denotes single ownership (atomic_flag, true == virtual_page_transfer_state, false otherwise), buffer transferring in progress
+    //loading_state is the transfer_state of a null -> linked transition (the fill) - the other faulting threads wait for the one fill + map the linked page, a miss is transferred once regardless of the faulting thread count
     //other state denotes the at-the-time physical page linkage + reference counting 
     //physical -> virtual is "injective" 
     //an atomic change to the state is valid if all reqs are met 
-    struct VirtualPageState{
-        alignas(CACHE_LINE_SIZE) dg_atomic_type<virtual_page_state_t> state; 
+    //one cache line of virtual page states - a padded table uses the first state of every block, a packed table uses all of them
+    struct VirtualPageStateBlock{
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<virtual_page_state_t> state_list[VIRTUAL_PAGE_STATE_PER_BLOCK]; 
+    };
+
+    static_assert(sizeof(VirtualPageStateBlock) == CACHE_LINE_SIZE && sizeof(dg_atomic_type<virtual_page_state_t>) * VIRTUAL_PAGE_STATE_PER_BLOCK == CACHE_LINE_SIZE);
+
+    //the states + linked bits of a contiguous run of virtual pages - allocated zeroed (null_state, unlinked) when a page of the run is first linked
+    struct VirtualPageLeaf{
+        VirtualPageStateBlock block_list[VIRTUAL_PAGE_LEAF_BLOCK_COUNT];
+        dg_atomic_type<uint64_t> linked_bitmap[VIRTUAL_PAGE_LEAF_BLOCK_COUNT * VIRTUAL_PAGE_STATE_PER_BLOCK / LINKED_BITMAP_WORD_BITCOUNT]; //sized for packed, padded uses the first words. bit i is set while page i of the leaf is linked (or in transfer from linked) - may be stale-set, never stale-clear
+    };
+
+    //two-level virtual page table - leaf_list[i] is null until a page of leaf i is linked, installed by cmpexch. lookups that do not link read an absent leaf as null_state. leaves live as long as the table
+    struct VirtualPageDirectory{
+        dg_atomic_type<VirtualPageLeaf *> * leaf_list; //calloc'ed - the zero pages are mapped on first touch, so neither init time nor rss scales with translator_sz
+        size_t leaf_list_sz;
+
+        VirtualPageDirectory() noexcept: leaf_list(nullptr),
+                                         leaf_list_sz(0u){}
+
+        VirtualPageDirectory(const VirtualPageDirectory&) = delete;
+        VirtualPageDirectory& operator =(const VirtualPageDirectory&) = delete;
+
+        ~VirtualPageDirectory() noexcept{
+
+            for (size_t i = 0; i < this->leaf_list_sz; ++i){
+                delete dg_atomic_load(this->leaf_list[i], std::memory_order_relaxed);
+            }
+
+            std::free(this->leaf_list);
+        }
+    };
+
+    //compressed copy of an unlinked virtual page - data is empty for a zero page, a run-length stream otherwise (see victim_tier_compress)
+    struct VictimTierEntry{
+        std::vector<uint8_t> data;
+        std::list<size_t>::iterator lru_it;
+    };
+
+    struct VictimTierShard{
+        alignas(CACHE_LINE_SIZE) std::mutex mtx;
+        std::unordered_map<size_t, VictimTierEntry> entry_map; //virtual page_idx -> entry
+        std::list<size_t> lru_list; //front is the most recently evicted
+        size_t byte_sz; //charged bytes of entry_map
+    };
+
+    //second tier between the translatee pages and the translator - evicted pages are kept compressed, a fill of an entry is a decompression instead of a virtual_to_physical transfer
+    //write-through: the translator is written back as without the tier, so an entry is always a copy of up-to-date virtual memory + dropping entries never loses data
+    //an entry only exists while its virtual page is unlinked - the fill takes (erases) it, so a relinked + rewritten page never meets a stale entry
+    struct VictimTier{
+        VictimTierShard shard_list[VICTIM_TIER_SHARD_COUNT]; //page_idx % VICTIM_TIER_SHARD_COUNT
+        size_t shard_capacity; //charged bytes per shard
+    };
+
+    //descriptors queued for one device - transferred on transfer_batch_flush (or once full)
+    struct TransferBatch{
+        TransferDescriptor descriptor_list[TRANSFER_BATCH_DESCRIPTOR_SZ];
+        size_t descriptor_sz;
+    };
+
+    //tag is ((page_idx + 1) << THREAD_CACHE_PIN_BITCOUNT) | pin, 0 denotes empty
+    //a non-empty entry holds exactly one shared reference of page_idx (virtual_page_dec_ref on drop), pin is the thread-local reference count on top of it
+    //only the owning thread changes a pinned (pin != 0) entry, so pin arithmetic is a plain store. an idle (pin == 0) entry can be revoked by any thread via cmpexch to 0
+    struct ThreadCacheEntry{
+        dg_atomic_type<size_t> tag;
+        void * addr; //owning thread only
+        bool is_dirty; //owning thread only - the page was marked dirty through this entry. stays valid while the entry holds its reference (dirty is only cleared at zero ref)
+    };
+
+    //a suspended coroutine waiting for a transfer_state to clear - task(arg) is posted to executor once the page is published. never run on the publishing thread - a refused post is deferred to the next virtual_page_drain_deferred_waiter
+    struct TransferWaiter{
+        Executor executor;
+        executor_task_t task;
+        void * arg;
+    };
+
+    struct TransferWaiterShard{
+        alignas(CACHE_LINE_SIZE) std::mutex mtx;
+        std::unordered_map<size_t, std::vector<TransferWaiter>> waiter_map; //virtual page_idx -> waiters, in registration order
+    };
+
+    struct ClockHand{
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<size_t> hand;
+    };
+
+    struct TraceShard{
+        alignas(CACHE_LINE_SIZE) std::mutex mtx;
+        std::vector<TraceRecord> record_list; //TRACE_BUFFER_RECORD_COUNT reserved while tracing - appends never allocate
+    };
+
+    //records are buffered per shard (trace thread_id % TRACE_SHARD_COUNT) + handed to the sink in batches, so the records of a shard are in call order + the others are merged by timestamp
+    struct Trace{
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<bool> is_enabled; //read on every traced call - the shard lock is only taken if set
+        std::mutex mtx; //guards trace_start + trace_stop
+        TraceSink sink; //written while !is_enabled
+        size_t first_timestamp;
+        TraceShard shard_list[TRACE_SHARD_COUNT];
+    };
+
+    struct Table;
+    struct ThreadCache;
+
+    //shared between a table and the thread caches registered to it - outlives the table if threads still hold caches
+    struct ThreadCacheRegistry{
+        std::mutex mtx; //guards registration + revocation, never taken on the hit path
+        std::vector<ThreadCache *> cache_list;
+        Table * table; //nullptr once the table is torn down
+    };
+
+    struct ThreadCache{
+        ThreadCacheEntry entry_list[THREAD_CACHE_SZ];
+        std::shared_ptr<ThreadCacheRegistry> registry;
     };
 
     struct Table{
         Config config; 
-        PhysicalPageState * physical_page_list;
+        std::unique_ptr<PhysicalPageState[]> physical_page_list;
         size_t physical_page_list_sz;
-        VirtualPageState * virtual_page_list;
+        VirtualPageDirectory virtual_page_directory; //storage of the virtual page states - see virtual_page_state
+        size_t virtual_page_state_shift; //0 if packed, VIRTUAL_PAGE_STATE_BLOCK_SHIFT if padded
+        size_t virtual_page_leaf_shift; //log2(virtual pages per leaf)
         size_t virtual_page_list_sz;
+        size_t page_shift; //log2(config.page_sz) - slot/offset/index are shift + mask
+        ClockHand clock_hand_list[MAX_NUMA_NODE_COUNT]; //one per node - monotonic, physical_page_idx == numa_partition_first(.., node) + hand % (partition page count)
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<size_t> eviction_epoch; //bumped whenever a physical page is evicted or released - a failed acquisition only gives up if nobody made progress in the meantime
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<size_t> readahead_last_slot; //last missed page_idx + 1, 0 denotes none
+        dg_atomic_type<size_t> readahead_stride; //last observed miss stride (two's complement)
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<size_t> prefetch_inflight; //posted prefetch tasks that have not retired - the table must outlive them
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<size_t> parked_waiter_count; //threads parked on a transfer_state - publishers skip the notify if zero
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<size_t> transfer_waiter_count; //registered TransferWaiters - publishers skip the shard lookup if zero
+        TransferWaiterShard transfer_waiter_shard_list[TRANSFER_WAITER_SHARD_COUNT]; //page_idx % TRANSFER_WAITER_SHARD_COUNT
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<size_t> deferred_waiter_count; //TransferWaiters whose post was refused by the publisher - drainers skip the lock if zero
+        std::mutex deferred_waiter_mtx;
+        std::vector<TransferWaiter> deferred_waiter_list; //guarded by deferred_waiter_mtx
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<size_t> write_back_inflight; //linked pages held in transfer_state by a write back - they become evictable (or free) once the transfer completes, a failed acquisition does not give up meanwhile
+        FreeList free_list[FREE_LIST_SHARD_COUNT]; //grouped by node (see numa_shard_first) - physical_page_release pushes to the releasing thread's shard of the page's node, acquisition pops from the local group then steals from the remote ones
+        size_t numa_node_count; //config.numa_node_count
+        alignas(CACHE_LINE_SIZE) dg_atomic_type<bool> thread_cache_pressure; //set when eviction had to revoke thread caches - caches stop retaining idle entries until an eviction succeeds again
+        std::shared_ptr<ThreadCacheRegistry> thread_cache_registry;
+        std::unique_ptr<dg_atomic_type<uint64_t>[]> dirty_chunk_bitmap; //dirty_chunk_bitmap_word_per_page words per physical page, bit i denotes chunk i written since the last write back. empty if dirty_chunk_sz == 0
+        size_t dirty_chunk_bitmap_word_per_page;
+        std::unique_ptr<VictimTier> victim_tier; //null if config.victim_tier_sz == 0
+        Trace trace;
+        #if defined(__DG_TLB_STATS__)
+        std::shared_ptr<StatRegistry> stat_registry;
+        #endif
     };
 
     template <class T, size_t BIT_COUNT, std::enable_if_t<std::is_unsigned_v<T>, bool> = true>
@@ -259,359 +709,3467 @@ namespace dg::flush_on_cap_tlb{
         return index(_slot, page_sz) + _offset;
     } 
 
-    static inline Config config; //
-    static inline Table table; //
+    //slot/offset/index of the table page size - pow2 fast path
+    inline auto table_slot(const Table& table, size_t idx) noexcept -> size_t{
 
-    //memory-deduced-qualified == the result of (void) or (stateful) variables can be used to deduce the up-to-date of the at-the-time related variables
+        return idx >> table.page_shift;
+    }
 
-    //try acquire an empty_page. If found return up-to-date memory-deduced-qualified page_idx, nullopt otherwise (optional memory-deduced-qualified)
-    inline auto physical_page_try_acquire_empty() -> std::optional<size_t>{
+    inline auto table_offset(const Table& table, size_t idx) noexcept -> size_t{
 
-        for (size_t i = 0; i < table.physical_page_list_sz; ++i){
-            if (dg_atomic_flag_test_and_set(table.physical_page_list[i].is_acquired, std::memory_order_acq_rel)){
-                return i;
-            }
-        }
+        return idx & (table.config.page_sz - 1);
+    }
 
-        return std::nullopt;
+    inline auto table_index(const Table& table, size_t _slot) noexcept -> size_t{
+
+        return _slot << table.page_shift;
     }
 
-    //release page_idx(not memory-deduced-qualified)
-    inline void physical_page_release(size_t page_idx) noexcept{
+    //first physical page of the partition of node - partition i is [numa_partition_first(.., i), numa_partition_first(.., i + 1))
+    constexpr auto numa_partition_first(size_t page_count, size_t node_count, size_t node) noexcept -> size_t{
 
-        dg_atomic_flag_clear(table.physical_page_list[page_idx].is_acquired, std::memory_order_release);
-    } 
+        return node * page_count / node_count;
+    }
 
-    //make virtual_page state from page_idx + counter. a valid page_state is not null_state or transfer_state
-    constexpr auto virtual_page_make(size_t page_idx, size_t counter) noexcept -> virtual_page_state_t{
+    //the node whose partition holds physical_page_idx - inverse of numa_partition_first
+    inline auto numa_page_node(const Table& table, size_t physical_page_idx) noexcept -> size_t{
 
-        return (static_cast<virtual_page_state_t>(page_idx + 1) << REF_BITCOUNT) | static_cast<virtual_page_state_t>(counter);
-    } 
+        return ((physical_page_idx + 1) * table.numa_node_count - 1) / table.physical_page_list_sz;
+    }
 
-    //extract idx from a valid page_state
-    constexpr auto virtual_page_extract_idx(virtual_page_state_t state) noexcept -> size_t{
+    //first free list shard of the group of node - group i is [numa_shard_first(.., i), numa_shard_first(.., i + 1)), never empty
+    constexpr auto numa_shard_first(size_t node_count, size_t node) noexcept -> size_t{
 
-        return (state >> REF_BITCOUNT) - 1;
-    } 
+        return node * FREE_LIST_SHARD_COUNT / node_count;
+    }
 
-    //extract counter from a valid page_state
-    constexpr auto virtual_page_extract_counter(virtual_page_state_t state) noexcept -> size_t{
+    //the node the calling thread runs on - cached, refreshed every NUMA_NODE_REFRESH_INTERVAL calls. 0 if unknown (no getcpu)
+    inline auto numa_current_node() noexcept -> size_t{
 
-        return state & low<virtual_page_state_t>(std::integral_constant<size_t, REF_BITCOUNT>{});
+        #if defined(__linux__) && defined(SYS_getcpu)
+        thread_local size_t node        = 0u;
+        thread_local size_t call_count  = 0u;
+
+        if (call_count++ % NUMA_NODE_REFRESH_INTERVAL == 0u){
+            unsigned int cpu{};
+            unsigned int cpu_node{};
+
+            if (syscall(SYS_getcpu, &cpu, &cpu_node, nullptr) == 0){
+                node = cpu_node;
+            }
+        }
+
+        return node;
+        #else
+        return 0u;
+        #endif
     }
 
-    //exhaust physical_mem_space -> virtual_mem_space  
-    inline void virtual_physical_page_sync(size_t virtual_page_idx, size_t physical_page_idx) noexcept{
+    //the calling thread's node, folded into [0, table.numa_node_count) - no getcpu if NUMA awareness is disabled
+    inline auto numa_local_node(const Table& table) noexcept -> size_t{
 
-        char * virtual_ptr  = static_cast<char *>(config.translator_addr) + index(virtual_page_idx, PAGE_SZ);
-        char * physical_ptr = static_cast<char *>(config.translatee_addr) + index(physical_page_idx, PAGE_SZ);
+        if (table.numa_node_count == 1u){
+            return 0u;
+        }
 
-        config.physical_to_virtual_transfer_device(virtual_ptr, static_cast<const void *>(physical_ptr), PAGE_SZ);
-    } 
+        return numa_current_node() % table.numa_node_count;
+    }
 
-    //transfer virtual_mem_space -> physical_mem_space
-    inline void physical_virtual_page_sync(size_t physical_page_idx, size_t virtual_page_idx) noexcept{
+    #if defined(__DG_TLB_STATS__)
 
-        char * physical_ptr = static_cast<char *>(config.translatee_addr) + index(physical_page_idx, PAGE_SZ);
-        char * virtual_ptr  = static_cast<char *>(config.translator_addr) + index(virtual_page_idx, PAGE_SZ);
+    //the calling thread's stat blocks, one per table it has touched. folded into the registry at thread exit
+    struct StatHandle{
+        std::vector<std::unique_ptr<StatBlockOwner>> owner_list;
 
-        config.virtual_to_physical_transfer_device(physical_ptr, static_cast<const void *>(virtual_ptr), PAGE_SZ);
-    } 
+        ~StatHandle() noexcept;
+    };
 
-    //try release a page - true if successfully released (memory-deduced-qualified, false otherwise (not memory-deduced-qualified) 
-    inline auto virtual_page_try_release_if_zero_ref(size_t page_idx) noexcept -> bool{
+    static inline thread_local bool stat_handle_destroyed = false; //trivially destructible - hooks invoked during thread_local teardown (thread cache unregistration) are not counted
 
-        while (true){
-            auto state = dg_atomic_load(table.virtual_page_list[page_idx].state, std::memory_order_acquire); //atomic_load as an unfair randomizer
+    inline auto stat_block_get(Table& table) noexcept -> StatBlock *{
 
-            if (state == virtual_page_null_state){
-                return true;
-            }
-            
-            if (state == virtual_page_transfer_state){
-                return false;
-            }
+        if (stat_handle_destroyed){
+            return nullptr;
+        }
 
-            size_t physical_page_idx = virtual_page_extract_idx(state);
-            size_t counter = virtual_page_extract_counter(state);
-            
-            if (counter != 0u){
-                return false;
-            }
+        thread_local StatHandle handle{};
 
-            if (dg_compare_exchange_strong(table.virtual_page_list[page_idx].state, state, virtual_page_transfer_state, std::memory_order_acq_rel)){ //try acquiring atomic_flag from valid state (acq_rel is mandatory because of unfair randomizer, not mandatory otherwise (version_control))
-                virtual_physical_page_sync(page_idx, physical_page_idx); //transfers memory as permission granted
-                dg_atomic_exchange(table.virtual_page_list[page_idx].state, virtual_page_null_state, std::memory_order_release); //release atomic_flag + defaultize (because of injective req + single ownership, up-to-date + mem-safe req are met)
-                physical_page_release(physical_page_idx); //release physical_page, mem_safe req is met (release after null_state for symmetry, as initialized)
-                dg_atomic_thread_fence(std::memory_order_acquire);
-                return true;
+        for (auto& owner: handle.owner_list){
+            if (owner->registry == table.stat_registry){
+                return &owner->block;
             }
         }
-    }   
 
-    //try synchronize a page - true if successfully synchronized (...), false otherwise (...). true denotes the at-the-time page is up-to-date.   
-    inline auto virtual_page_try_sync(size_t page_idx) noexcept -> bool{
+        try{
+            auto is_orphaned = [](const std::unique_ptr<StatBlockOwner>& owner){return owner->registry.use_count() == 1;}; //the table is gone
+            handle.owner_list.erase(std::remove_if(handle.owner_list.begin(), handle.owner_list.end(), is_orphaned), handle.owner_list.end());
 
-        while (true){
-            auto state = dg_atomic_load(table.virtual_page_list[page_idx].state, std::memory_order_acquire); //atomic load as an unfair randomizer
+            auto owner = std::make_unique<StatBlockOwner>();
 
-            if (state == virtual_page_null_state){
-                return true;
-            }
-            
-            if (state == virtual_page_transfer_state){
-                return false;
+            for (size_t i = 0; i < STAT_COUNT; ++i){
+                dg_atomic_store(owner->block.counter_list[i], size_t{0u}, std::memory_order_relaxed);
             }
 
-            size_t physical_page_idx = virtual_page_extract_idx(state);
-            size_t counter = virtual_page_extract_counter(state);
-            
-            if (counter != 0u){
-                return false;
+            for (size_t i = 0; i < STAT_HISTOGRAM_BUCKET_COUNT; ++i){
+                dg_atomic_store(owner->block.miss_latency_histogram[i], size_t{0u}, std::memory_order_relaxed);
             }
 
-            if (dg_compare_exchange_strong(table.virtual_page_list[page_idx].state, state, virtual_page_transfer_state, std::memory_order_acq_rel)){ //try acquiring atomic_flag from valid state (acq_rel is mandatory because of unfair randomizer, not mandatory otherwise (version_control))
-                virtual_physical_page_sync(page_idx, physical_page_idx); //transfers memory as permission granted
-                dg_atomic_exchange(table.virtual_page_list[page_idx].state, state, std::memory_order_release); //release atomic_flag + snap back to org_state (should obey the rules as others are immutable during atomic_flag acquisition - single ownership rule)
-                dg_atomic_thread_fence(std::memory_order_acquire);
-                return true;
+            for (size_t i = 0; i < MAX_NUMA_NODE_COUNT; ++i){
+                dg_atomic_store(owner->block.numa_acquire_list[i], size_t{0u}, std::memory_order_relaxed);
             }
-        } 
-    } 
-
-    //try release all available pages (not memory-deduced-qualified)
-    inline void virtual_page_release_zero_ref() noexcept{
 
-        for (size_t i = 0; i < table.virtual_page_list_sz; ++i){
-            virtual_page_try_release_if_zero_ref(i);
+            owner->registry = table.stat_registry;
+            handle.owner_list.reserve(handle.owner_list.size() + 1);
+            {
+                std::lock_guard<std::mutex> lck_grd(owner->registry->mtx);
+                owner->registry->block_list.push_back(&owner->block);
+            }
+            handle.owner_list.push_back(std::move(owner)); //reserved - does not throw
+        } catch (...){
+            return nullptr; //out of memory - not counted
         }
+
+        return &handle.owner_list.back()->block;
     }
-    
-    //try acquire an empty page - if failed - release + retry. If succeeded - return memory-deduced-qualified physical_page_idx. If throw, throw memory-deduced-qualified no_page_found 
-    inline auto physical_page_force_acquire_empty() -> size_t{
 
-        if (auto rs = physical_page_try_acquire_empty(); rs){
-            return rs.value();
-        }
+    inline StatHandle::~StatHandle() noexcept{
 
-        virtual_page_release_zero_ref();
+        stat_handle_destroyed = true;
 
-        if (auto rs = physical_page_try_acquire_empty(); rs){
-            return rs.value();
-        }
+        for (auto& owner: owner_list){
+            StatRegistry& registry = *owner->registry;
+            std::lock_guard<std::mutex> lck_grd(registry.mtx);
+            registry.block_list.erase(std::find(registry.block_list.begin(), registry.block_list.end(), &owner->block));
 
-        dg_atomic_thread_fence(std::memory_order_acquire);
-        throw no_page_found();
-    } 
+            for (size_t i = 0; i < STAT_COUNT; ++i){
+                registry.retired.counter_list[i] += dg_atomic_load(owner->block.counter_list[i], std::memory_order_relaxed);
+            }
 
-    //try establish linkage to physical_page and increment reference of page_idx virtual page - return the at-the-time linked addr (memory-deduced-qualified if non-null, not qualified otherwise). The at-the-time pointer lifetime is guaranteed up-to the invoke of virtual_page_dec_ref.
-    inline auto virtual_page_try_link_n_inc_ref(size_t page_idx) -> void *{
+            for (size_t i = 0; i < STAT_HISTOGRAM_BUCKET_COUNT; ++i){
+                registry.retired.miss_latency_histogram[i] += dg_atomic_load(owner->block.miss_latency_histogram[i], std::memory_order_relaxed);
+            }
 
-        size_t physical_page_idx = physical_page_force_acquire_empty();
-        auto state  = virtual_page_make(physical_page_idx, 1u);
-        physical_virtual_page_sync(physical_page_idx, page_idx);
-        
-        if (dg_compare_exchange_strong(table.virtual_page_list[page_idx].state, virtual_page_null_state, state, std::memory_order_acq_rel)){
-            return table.physical_page_list[physical_page_idx].addr; 
+            for (size_t i = 0; i < MAX_NUMA_NODE_COUNT; ++i){
+                registry.retired.numa_acquire_list[i] += dg_atomic_load(owner->block.numa_acquire_list[i], std::memory_order_relaxed);
+            }
         }
+    }
 
-        physical_page_release(physical_page_idx);
-        return nullptr;
+    inline void stat_add(Table& table, Stat stat, size_t val = 1u) noexcept{
+
+        if (StatBlock * block = stat_block_get(table); block){
+            auto& counter = block->counter_list[static_cast<size_t>(stat)];
+            dg_atomic_store(counter, dg_atomic_load(counter, std::memory_order_relaxed) + val, std::memory_order_relaxed);
+        }
     }
 
-    //try map virtual_page to the linked physical_page + inc reference - return the at-the-time mapped addr (memory-deduced-qualified if non-null, not qualified otherwise). The at-the-time pointer lifetime is guaranteed up-to the invoke of virtual_page_dec_ref.
-    inline auto virtual_page_try_map_n_inc_ref_if_exists(size_t page_idx) noexcept -> void *{
+    inline auto stat_timestamp() noexcept -> size_t{
 
-        while (true){
-            auto cur_state      = dg_atomic_load(table.virtual_page_list[page_idx].state, std::memory_order_acquire);
-            
-            if (cur_state == virtual_page_null_state){
-                return nullptr;
-            }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
 
-            if (cur_state == virtual_page_transfer_state){
-                continue;
-            }
+    //physical_page_idx was acquired by the calling thread
+    inline void stat_add_numa_acquire(Table& table, size_t physical_page_idx) noexcept{
 
-            size_t idx          = virtual_page_extract_idx(cur_state);
-            size_t counter      = virtual_page_extract_counter(cur_state);
-            auto nxt_state      = virtual_page_make(idx, counter + 1);
-            
-            if (dg_compare_exchange_strong(table.virtual_page_list[page_idx].state, cur_state, nxt_state, std::memory_order_acq_rel)){
-                return table.physical_page_list[idx].addr;
-            }
+        size_t node = numa_page_node(table, physical_page_idx);
+
+        if (StatBlock * block = stat_block_get(table); block){
+            auto& counter = block->numa_acquire_list[node];
+            dg_atomic_store(counter, dg_atomic_load(counter, std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+        }
+
+        if (node != numa_local_node(table)){
+            stat_add(table, Stat::numa_remote_acquire);
         }
     }
 
-    //force map (link if necessary). return the non-null at-the-time mapped_addr (memory-deduced-qualified). throw no_page_found if the at-the-time linkage could not be established. The at-the-time pointer lifetime is guaranteed up-to the invoke of virtual_page_dec_ref.
-    inline auto virtual_page_force_fetch_n_inc_ref(size_t page_idx) -> void *{
+    inline void stat_record_miss_latency(Table& table, size_t first_timestamp) noexcept{
 
-        while (true){
-            if (void * rs = virtual_page_try_map_n_inc_ref_if_exists(page_idx); rs){
-                return rs;
-            }
+        size_t elapsed  = stat_timestamp() - first_timestamp;
+        size_t bucket   = 0u;
 
-            if (void * rs = virtual_page_try_link_n_inc_ref(page_idx); rs){
-                return rs;
-            }
+        while (bucket + 1 < STAT_HISTOGRAM_BUCKET_COUNT && (elapsed >> (bucket + 1)) != 0u){
+            bucket += 1;
+        }
+
+        if (StatBlock * block = stat_block_get(table); block){
+            auto& counter = block->miss_latency_histogram[bucket];
+            dg_atomic_store(counter, dg_atomic_load(counter, std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
         }
     }
 
-    //decrease reference of the page_idx virtual_page (not memory-deduced-qualified (void))
-    inline void virtual_page_dec_ref(size_t page_idx) noexcept{
+    //aggregate the live blocks + the retired blocks. counters of live threads are at-the-time relaxed reads (not memory-deduced-qualified)
+    inline auto stat_snapshot(Table& table) noexcept -> Stats{
 
-        while (true){
-            auto cur_state      = dg_atomic_load(table.virtual_page_list[page_idx].state, std::memory_order_acquire);
+        std::lock_guard<std::mutex> lck_grd(table.stat_registry->mtx);
+        Stats rs = table.stat_registry->retired;
 
-            if (cur_state == virtual_page_transfer_state){
-                continue;
+        for (StatBlock * block: table.stat_registry->block_list){
+            for (size_t i = 0; i < STAT_COUNT; ++i){
+                rs.counter_list[i] += dg_atomic_load(block->counter_list[i], std::memory_order_relaxed);
             }
 
-            size_t page_idx     = virtual_page_extract_idx(cur_state);
-            size_t counter      = virtual_page_extract_counter(cur_state);
-            auto new_state      = virtual_page_make(page_idx, counter - 1); 
+            for (size_t i = 0; i < STAT_HISTOGRAM_BUCKET_COUNT; ++i){
+                rs.miss_latency_histogram[i] += dg_atomic_load(block->miss_latency_histogram[i], std::memory_order_relaxed);
+            }
 
-            if (dg_compare_exchange_strong(table.virtual_page_list[page_idx].state, cur_state, new_state, std::memory_order_release)){ //no guarantee that state is the same at load and cmp_exchg_strong. atomic_load as an unfair randomizer
-                return;
+            for (size_t i = 0; i < MAX_NUMA_NODE_COUNT; ++i){
+                rs.numa_acquire_list[i] += dg_atomic_load(block->numa_acquire_list[i], std::memory_order_relaxed);
             }
         }
+
+        return rs;
     }
 
-    //wait + drop the page_idx virtual page. the exit of this function guarantees the up-to-date as of at least __function_invoked_time__ (memory-deduced-qualified (void))
-    inline void virtual_page_drop(size_t page_idx) noexcept{
+    #else
 
-        while (!virtual_page_try_release_if_zero_ref(page_idx)){} //schedulers here 
-    }
+    inline void stat_add(Table&, Stat, size_t = 1u) noexcept{}
 
-    //wait + sync the page_idx virtual_page. the exit of this function guarantees the up-to-date as of at least __function_invoked_time__ (memory-deduced-qualified (void))
-    inline void virtual_page_sync(size_t page_idx) noexcept{
+    inline void stat_add_numa_acquire(Table&, size_t) noexcept{}
+
+    constexpr auto stat_timestamp() noexcept -> size_t{
 
-        while (!virtual_page_try_sync(page_idx)){} //schedulers here
+        return 0u;
     }
 
-    //wait + drop all pages. the exit of this function guarantees the up-to-date as of at least __function_invoked_time__ (memory-deduced-qualified (void))
-    inline void virtual_page_drop_all() noexcept{
+    inline void stat_record_miss_latency(Table&, size_t) noexcept{}
 
-        for (size_t i = 0; i < table.virtual_page_list_sz; ++i){
-            virtual_page_drop(i);
-        }
+    inline auto stat_snapshot(Table&) noexcept -> Stats{
+
+        return Stats{};
     }
 
-    //wait + sync all pages. the exit of this function guarantees the up-to-date as of at least __function_invoked_time__ ...
-    inline void virtual_page_sync_all() noexcept{
+    #endif
 
-        for (size_t i = 0; i < table.virtual_page_list_sz; ++i){
-            virtual_page_sync(i);
-        }
-    }
-    
-    //--user-interface--
+    //install a zeroed leaf at leaf_idx - the loser of a concurrent install frees its leaf. out of memory aborts, the callers are noexcept
+    inline auto virtual_page_leaf_install(Table& table, size_t leaf_idx) noexcept -> VirtualPageLeaf *{
 
-    //should be invoked once - at the beginning of the program
-    inline void init(char * translator_addr, size_t translator_sz,
-                     char * translatee_addr, size_t translatee_sz,
-                     mem_transfer_device_t virtual_to_physical_transfer_device,
-                     mem_transfer_device_t physical_to_virtual_transfer_device){
-                    
-        if (translator_sz % PAGE_SZ != 0u || translator_sz == 0u || reinterpret_cast<uintptr_t>(translator_addr) % PAGE_SZ != 0u || reinterpret_cast<uintptr_t>(translator_addr) / PAGE_SZ == 0u){ //page_offs != 0, bad practice - but necessary for remapping nullptr
+        auto * leaf = new (std::nothrow) VirtualPageLeaf(); 
+
+        if (leaf == nullptr){
             std::abort();
         }
 
-        if (translatee_sz % PAGE_SZ != 0u || translatee_sz == 0u || reinterpret_cast<uintptr_t>(translatee_addr) % PAGE_SZ != 0u || reinterpret_cast<uintptr_t>(translatee_addr) / PAGE_SZ == 0u){ //page_offs != 0, bad practice - but necessary for remapping nullptr
-            std::abort();
+        if (dg_compare_exchange_strong(table.virtual_page_directory.leaf_list[leaf_idx], static_cast<VirtualPageLeaf *>(nullptr), leaf, std::memory_order_acq_rel)){
+            stat_add(table, Stat::virtual_page_leaf_alloc);
+            return leaf;
         }
 
-        size_t translator_page_count    = translator_sz / PAGE_SZ;
-        auto translator_pages           = std::make_unique<VirtualPageState[]>(translator_page_count);
-        size_t translatee_page_count    = translatee_sz / PAGE_SZ;
-        auto translatee_pages           = std::make_unique<PhysicalPageState[]>(translatee_page_count);
+        delete leaf;
+        return dg_atomic_load(table.virtual_page_directory.leaf_list[leaf_idx], std::memory_order_acquire);
+    }
 
-        for (size_t i = 0; i < translator_page_count; ++i){
-            dg_atomic_exchange(translator_pages[i].state, virtual_page_null_state, std::memory_order_seq_cst);
-        }
+    inline auto virtual_page_leaf(Table& table, size_t page_idx) noexcept -> VirtualPageLeaf&{
 
-        for (size_t i = 0; i < translatee_page_count; ++i){
-            translatee_pages[i].addr = translatee_addr + (PAGE_SZ * i); 
-            dg_atomic_flag_clear(translatee_pages[i].is_acquired, std::memory_order_seq_cst);
-        }
+        size_t leaf_idx         = page_idx >> table.virtual_page_leaf_shift;
+        VirtualPageLeaf * leaf  = dg_atomic_load(table.virtual_page_directory.leaf_list[leaf_idx], std::memory_order_acquire);
 
-        config                      = {translator_addr, translator_sz, translatee_addr, translatee_sz, virtual_to_physical_transfer_device, physical_to_virtual_transfer_device};
-        table.virtual_page_list_sz  = translator_page_count;
-        table.virtual_page_list     = translator_pages.get();
-        table.physical_page_list_sz = translatee_page_count;
-        table.physical_page_list    = translatee_pages.get();
+        if (leaf == nullptr){
+            leaf = virtual_page_leaf_install(table, leaf_idx);
+        }
 
-        translator_pages.release();
-        translatee_pages.release();
+        return *leaf;
     }
 
-    inline auto map(void * ptr) -> void *{
+    //the state of page_idx in its leaf
+    inline auto virtual_page_leaf_state(const Table& table, VirtualPageLeaf& leaf, size_t page_idx) noexcept -> dg_atomic_type<virtual_page_state_t>&{
 
-        if (!ptr){
-            return nullptr;
+        size_t pos = (page_idx << table.virtual_page_state_shift) & ((VIRTUAL_PAGE_LEAF_BLOCK_COUNT << VIRTUAL_PAGE_STATE_BLOCK_SHIFT) - 1);
+        return leaf.block_list[pos >> VIRTUAL_PAGE_STATE_BLOCK_SHIFT].state_list[pos & (VIRTUAL_PAGE_STATE_PER_BLOCK - 1)];
+    }
+
+    //the state of page_idx - first touch of a leaf allocates it. only the link paths (a claim from null_state) touch an absent leaf, every other path loads through virtual_page_load_state first
+    inline auto virtual_page_state(Table& table, size_t page_idx) noexcept -> dg_atomic_type<virtual_page_state_t>&{
+
+        return virtual_page_leaf_state(table, virtual_page_leaf(table, page_idx), page_idx);
+    }
+
+    //load the state of page_idx - an absent leaf reads as null_state, nothing is allocated. a non-null state implies the leaf is present
+    inline auto virtual_page_load_state(Table& table, size_t page_idx, std::memory_order mem_order) noexcept -> virtual_page_state_t{
+
+        VirtualPageLeaf * leaf = dg_atomic_load(table.virtual_page_directory.leaf_list[page_idx >> table.virtual_page_leaf_shift], std::memory_order_acquire);
+
+        if (leaf == nullptr){
+            return virtual_page_null_state;
+        }
+
+        return dg_atomic_load(virtual_page_leaf_state(table, *leaf, page_idx), mem_order);
+    }
+
+    inline auto virtual_page_linked_word(Table& table, size_t page_idx) noexcept -> dg_atomic_type<uint64_t>&{
+
+        size_t leaf_offs = page_idx & ((size_t{1} << table.virtual_page_leaf_shift) - 1);
+        return virtual_page_leaf(table, page_idx).linked_bitmap[leaf_offs / LINKED_BITMAP_WORD_BITCOUNT];
+    }
+
+    //first linked page_idx of [first, last), last if none - absent leaves + clear words are skipped, nothing is allocated
+    inline auto virtual_page_next_linked(Table& table, size_t first, size_t last) noexcept -> size_t{
+
+        size_t leaf_page_count = size_t{1} << table.virtual_page_leaf_shift;
+
+        while (first < last){
+            size_t leaf_idx         = first >> table.virtual_page_leaf_shift;
+            size_t leaf_last        = std::min((leaf_idx + 1) << table.virtual_page_leaf_shift, last);
+            VirtualPageLeaf * leaf  = dg_atomic_load(table.virtual_page_directory.leaf_list[leaf_idx], std::memory_order_acquire);
+
+            if (leaf == nullptr){
+                first = leaf_last;
+                continue;
+            }
+
+            size_t leaf_offs    = first & (leaf_page_count - 1);
+            size_t word_idx     = leaf_offs / LINKED_BITMAP_WORD_BITCOUNT;
+            uint64_t word       = dg_atomic_load(leaf->linked_bitmap[word_idx], std::memory_order_acquire) & (~uint64_t{0u} << (leaf_offs % LINKED_BITMAP_WORD_BITCOUNT));
+            size_t leaf_first   = first - leaf_offs;
+
+            while (word == 0u){
+                word_idx += 1;
+
+                if (leaf_first + word_idx * LINKED_BITMAP_WORD_BITCOUNT >= leaf_last){
+                    break;
+                }
+
+                word = dg_atomic_load(leaf->linked_bitmap[word_idx], std::memory_order_acquire);
+            }
+
+            if (word != 0u){
+                return std::min(leaf_first + word_idx * LINKED_BITMAP_WORD_BITCOUNT + countr_zero(word), last);
+            }
+
+            first = leaf_last;
+        }
+
+        return last;
+    }
+
+    static inline dg_atomic_type<size_t> trace_thread_counter{}; //trace thread_id assignment, shared by every table
+
+    inline auto trace_timestamp() noexcept -> size_t{
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //hand the buffered records of the locked shard to the sink
+    inline void trace_shard_drain(Trace& trace, TraceShard& shard) noexcept{
+
+        if (!shard.record_list.empty()){
+            trace.sink.write(trace.sink.ctx, shard.record_list.data(), shard.record_list.size());
+            shard.record_list.clear();
+        }
+    }
+
+    //append a record of the calling thread to its shard - the traced path of trace_record, kept apart so the untraced check inlines into the hot paths
+    inline void trace_append(Table& table, TraceOp op, size_t offs, size_t sz) noexcept{
+
+        thread_local size_t thread_id   = dg_atomic_fetch_add(trace_thread_counter, size_t{1}, std::memory_order_relaxed);
+        TraceShard& shard               = table.trace.shard_list[thread_id % TRACE_SHARD_COUNT];
+        std::lock_guard<std::mutex> lck_grd(shard.mtx);
+
+        if (!dg_atomic_load(table.trace.is_enabled, std::memory_order_acquire)){ //stopped meanwhile - the shard is drained
+            return;
+        }
+
+        if (shard.record_list.size() == TRACE_BUFFER_RECORD_COUNT){
+            trace_shard_drain(table.trace, shard);
+        }
+
+        TraceRecord record{};
+        record.timestamp    = trace_timestamp() - table.trace.first_timestamp;
+        record.offs         = offs;
+        record.sz           = static_cast<uint32_t>(std::min(sz, size_t{UINT32_MAX}));
+        record.thread_id    = static_cast<uint16_t>(thread_id);
+        record.op           = static_cast<uint8_t>(op);
+        shard.record_list.push_back(record); //reserved - does not throw
+    }
+
+    //append a record of the calling thread - one relaxed load if not tracing
+    inline void trace_record(Table& table, TraceOp op, size_t offs, size_t sz = 0u) noexcept{
+
+        if (dg_atomic_load(table.trace.is_enabled, std::memory_order_relaxed)){
+            trace_append(table, op, offs, sz);
+        }
+    }
+
+    //flush the shard buffers to the sink + clear is_enabled - trace.mtx is held
+    inline void trace_disable(Table& table) noexcept{
+
+        if (!dg_atomic_load(table.trace.is_enabled, std::memory_order_relaxed)){
+            return;
+        }
+
+        dg_atomic_store(table.trace.is_enabled, false, std::memory_order_relaxed);
+
+        for (auto& shard: table.trace.shard_list){ //a recorder holding the lock appends before the drain, the later ones see !is_enabled
+            std::lock_guard<std::mutex> shard_lck_grd(shard.mtx);
+            trace_shard_drain(table.trace, shard);
+        }
+    }
+
+    //flush the shard buffers to the sink + stop recording - no sink invocation after return. no-op if not tracing
+    inline void trace_stop(Table& table) noexcept{
+
+        std::lock_guard<std::mutex> lck_grd(table.trace.mtx);
+        trace_disable(table);
+    }
+
+    //stop the running trace (if any) + record to sink from now on
+    inline void trace_start(Table& table, TraceSink sink){
+
+        if (sink.write == nullptr){
+            std::abort();
+        }
+
+        std::lock_guard<std::mutex> lck_grd(table.trace.mtx);
+        trace_disable(table);
+
+        for (auto& shard: table.trace.shard_list){
+            std::lock_guard<std::mutex> shard_lck_grd(shard.mtx);
+            shard.record_list.reserve(TRACE_BUFFER_RECORD_COUNT);
+        }
+
+        if (sink.header != nullptr){
+            TraceHeader header{TRACE_MAGIC, TRACE_VERSION, table.config.page_sz, table.config.translator_sz, table.config.translatee_sz, static_cast<uint64_t>(table.config.eviction_policy),
+                               table.config.thread_cache_enabled, table.config.dirty_chunk_sz, table.config.readahead_page_count, static_cast<uint64_t>(table.config.page_table_layout), table.config.victim_tier_sz, table.config.numa_node_count};
+            sink.header(sink.ctx, header);
+        }
+
+        table.trace.sink            = sink;
+        table.trace.first_timestamp = trace_timestamp();
+        dg_atomic_store(table.trace.is_enabled, true, std::memory_order_release);
+    }
+
+    static inline dg_atomic_type<size_t> free_list_thread_counter{}; //round robin shard assignment for new threads, shared by every table
+
+    //memory-deduced-qualified == the result of (void) or (stateful) variables can be used to deduce the up-to-date of the at-the-time related variables
+
+    constexpr auto free_list_make_head(size_t link, uint64_t tag) noexcept -> uint64_t{
+
+        return (tag << FREE_LIST_LINK_BITCOUNT) | static_cast<uint64_t>(link);
+    }
+
+    constexpr auto free_list_extract_link(uint64_t head) noexcept -> size_t{
+
+        return head & low<uint64_t>(std::integral_constant<size_t, FREE_LIST_LINK_BITCOUNT>{});
+    }
+
+    constexpr auto free_list_extract_tag(uint64_t head) noexcept -> uint64_t{
+
+        return head >> FREE_LIST_LINK_BITCOUNT;
+    }
+
+    //the calling thread's shard in the group of node - assigned once per thread, round robin, so threads do not pile onto the same head 
+    inline auto free_list_node_shard(const Table& table, size_t node) noexcept -> size_t{
+
+        thread_local size_t thread_idx  = dg_atomic_fetch_add(free_list_thread_counter, size_t{1}, std::memory_order_relaxed);
+        size_t first                    = numa_shard_first(table.numa_node_count, node);
+        size_t last                     = numa_shard_first(table.numa_node_count, node + 1);
+
+        return first + thread_idx % (last - first);
+    }
+
+    //try pop a page from the shard. If found return memory-deduced-qualified page_idx, nullopt otherwise
+    inline auto free_list_try_pop(Table& table, size_t shard) noexcept -> std::optional<size_t>{
+
+        auto& head = table.free_list[shard].head;
+
+        while (true){
+            uint64_t cur_head   = dg_atomic_load(head, std::memory_order_acquire);
+            size_t link         = free_list_extract_link(cur_head);
+
+            if (link == 0u){
+                return std::nullopt;
+            }
+
+            size_t page_idx     = link - 1;
+            size_t nxt_link     = dg_atomic_load(table.physical_page_list[page_idx].next, std::memory_order_relaxed); //might be stale if page_idx was popped in the meantime - the tag fails the cmpexch then
+            uint64_t nxt_head   = free_list_make_head(nxt_link, free_list_extract_tag(cur_head) + 1u);
+
+            if (dg_compare_exchange_strong(head, cur_head, nxt_head, std::memory_order_acq_rel)){
+                return page_idx;
+            }
+        }
+    }
+
+    //push page_idx to the shard (not memory-deduced-qualified)
+    inline void free_list_push(Table& table, size_t shard, size_t page_idx) noexcept{
+
+        auto& head = table.free_list[shard].head;
+
+        while (true){
+            uint64_t cur_head   = dg_atomic_load(head, std::memory_order_relaxed);
+            uint64_t nxt_head   = free_list_make_head(page_idx + 1, free_list_extract_tag(cur_head) + 1u);
+            dg_atomic_exchange(table.physical_page_list[page_idx].next, free_list_extract_link(cur_head), std::memory_order_relaxed); //published by the cmpexch below
+
+            if (dg_compare_exchange_strong(head, cur_head, nxt_head, std::memory_order_release)){
+                return;
+            }
+        }
+    }
+
+    //try acquire an empty_page - O(1) from the home shard, steal from the other shards of the local node, then from the remote nodes (nearest index first) if empty
+    //If found return up-to-date memory-deduced-qualified page_idx, nullopt otherwise (optional memory-deduced-qualified)
+    inline auto physical_page_try_acquire_empty(Table& table) noexcept -> std::optional<size_t>{
+
+        size_t local_node   = numa_local_node(table);
+        size_t home_shard   = free_list_node_shard(table, local_node);
+        size_t first        = numa_shard_first(table.numa_node_count, local_node);
+        size_t last         = numa_shard_first(table.numa_node_count, local_node + 1);
+
+        for (size_t i = 0; i < last - first; ++i){
+            if (auto rs = free_list_try_pop(table, first + (home_shard - first + i) % (last - first)); rs){
+                stat_add_numa_acquire(table, rs.value());
+                return rs;
+            }
+        }
+
+        for (size_t i = 0; i < FREE_LIST_SHARD_COUNT - (last - first); ++i){
+            if (auto rs = free_list_try_pop(table, (last + i) % FREE_LIST_SHARD_COUNT); rs){
+                stat_add_numa_acquire(table, rs.value());
+                return rs;
+            }
         }
 
-        size_t idx              = std::distance(static_cast<const char *>(config.translator_addr), static_cast<const char *>(ptr));
-        size_t page_slot        = slot(idx, PAGE_SZ);
-        size_t page_offs        = offset(idx, PAGE_SZ);
-        void * translatee_page  = virtual_page_force_fetch_n_inc_ref(page_slot);  
+        return std::nullopt;
+    }
+
+    //release page_idx(not memory-deduced-qualified)
+    inline void physical_page_release(Table& table, size_t page_idx) noexcept{
 
-        return static_cast<char *>(translatee_page) + page_offs;
+        free_list_push(table, free_list_node_shard(table, numa_page_node(table, page_idx)), page_idx); //back to the partition's node
+        dg_atomic_fetch_add(table.eviction_epoch, size_t{1}, std::memory_order_relaxed);
     } 
 
-    inline void unmap(void * ptr) noexcept{
+    inline void cpu_relax() noexcept{
+
+        #if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+        #elif defined(__aarch64__)
+        asm volatile("yield");
+        #endif
+    }
+
+    //one round of backoff - exponential pause spins, then yields, then short sleeps. round starts at 0 and is advanced by the call
+    inline void backoff(size_t& round) noexcept{
 
-        if (!ptr){
+        if (round < WAIT_PAUSE_ROUND){
+            for (size_t i = 0; i < (size_t{1} << round); ++i){
+                cpu_relax();
+            }
+        } else if (round < WAIT_PAUSE_ROUND + WAIT_YIELD_ROUND){
+            std::this_thread::yield();
+        } else{
+            std::this_thread::sleep_for(std::chrono::microseconds(WAIT_SLEEP_US));
+            return; //saturated
+        }
+
+        round += 1;
+    }
+
+    //wait for the page_idx virtual page to leave state (transfer_state or loading_state) - backoff first, then park on the state word until the transferring thread publishes (virtual_page_release_transfer)
+    //a fill is a whole page transfer - loading_state skips the pause rounds. returns on a spurious wakeup or if the state already changed - the caller reloads the state (not memory-deduced-qualified (void))
+    inline void virtual_page_wait_transfer(Table& table, size_t page_idx, virtual_page_state_t state, size_t& round) noexcept{
+
+        if (state == virtual_page_loading_state){
+            round = std::max(round, WAIT_PAUSE_ROUND);
+        }
+
+        if (round < WAIT_PAUSE_ROUND + WAIT_YIELD_ROUND){
+            backoff(round);
             return;
         }
 
-        size_t idx          = std::distance(static_cast<const char *>(config.translator_addr), static_cast<const char *>(ptr));
-        size_t page_slot    = slot(idx, PAGE_SZ);
-        virtual_page_dec_ref(page_slot);
+        dg_atomic_fetch_add(table.parked_waiter_count, size_t{1}, std::memory_order_seq_cst); //seq_cst pairs with virtual_page_release_transfer - either the publisher sees the waiter or the waiter sees the published state
+        dg_atomic_wait(virtual_page_state(table, page_idx), state, std::memory_order_seq_cst);
+        dg_atomic_fetch_sub(table.parked_waiter_count, size_t{1}, std::memory_order_relaxed);
     }
 
-    inline void shootdown(void * ptr) noexcept{
+    //post the TransferWaiters of the page_idx virtual page - invoked by the publisher of its transfer_state (not memory-deduced-qualified (void))
+    //a waiter is never run inline here - the publisher may hold other pages in transfer_state (batched write back), a resumed coroutine could wait on them. a refused post is deferred
+    inline void virtual_page_wake_transfer_waiter(Table& table, size_t page_idx) noexcept{
+
+        auto& shard = table.transfer_waiter_shard_list[page_idx % TRANSFER_WAITER_SHARD_COUNT];
+        std::vector<TransferWaiter> waiter_list{};
+
+        {
+            std::lock_guard<std::mutex> lck_grd(shard.mtx);
+            auto it = shard.waiter_map.find(page_idx);
+
+            if (it == shard.waiter_map.end()){
+                return;
+            }
+
+            waiter_list = std::move(it->second);
+            shard.waiter_map.erase(it);
+        }
+
+        dg_atomic_fetch_sub(table.transfer_waiter_count, waiter_list.size(), std::memory_order_relaxed);
+
+        size_t deferred_sz = 0u;
+
+        for (const TransferWaiter& waiter: waiter_list){
+            if (!waiter.executor.post(waiter.executor.ctx, waiter.task, waiter.arg)){ //registered waiters have a non-empty executor
+                waiter_list[deferred_sz++] = waiter;
+            }
+        }
 
-        if (!ptr){
+        if (deferred_sz == 0u){
             return;
         }
 
-        size_t idx          = std::distance(static_cast<const char *>(config.translator_addr), static_cast<const char *>(ptr));
-        size_t page_slot    = slot(idx, PAGE_SZ);
-        virtual_page_drop(page_slot);
+        try{
+            std::lock_guard<std::mutex> lck_grd(table.deferred_waiter_mtx);
+            table.deferred_waiter_list.insert(table.deferred_waiter_list.end(), waiter_list.begin(), std::next(waiter_list.begin(), deferred_sz));
+        } catch (...){ //out of memory - the publisher is noexcept
+            std::abort();
+        }
+
+        dg_atomic_fetch_add(table.deferred_waiter_count, deferred_sz, std::memory_order_release);
     }
 
-    inline void sync(void * ptr) noexcept{
+    //run the TransferWaiters deferred by virtual_page_wake_transfer_waiter - reposted, inline on the calling thread if refused again
+    //only invoked outside the publish path: on the awaiting thread (co_map, co_sync, an await_suspend that does not suspend) + by the posted awaitable tasks once their work is done
+    inline void virtual_page_drain_deferred_waiter(Table& table) noexcept{
+
+        if (dg_atomic_load(table.deferred_waiter_count, std::memory_order_acquire) == 0u){
+            return;
+        }
+
+        std::vector<TransferWaiter> waiter_list{};
+
+        {
+            std::lock_guard<std::mutex> lck_grd(table.deferred_waiter_mtx);
+            waiter_list.swap(table.deferred_waiter_list);
+        }
 
-        if (!ptr){
-            return; 
+        dg_atomic_fetch_sub(table.deferred_waiter_count, waiter_list.size(), std::memory_order_relaxed);
+
+        for (const TransferWaiter& waiter: waiter_list){
+            if (!waiter.executor.post(waiter.executor.ctx, waiter.task, waiter.arg)){
+                waiter.task(waiter.arg);
+            }
+        }
+    }
+
+    //register waiter on the page_idx virtual page while it is in state (transfer_state or loading_state) - no thread is held, the waiter is posted once the state is published
+    //false if the state changed before the registration was visible - nothing is registered, the caller reloads. throws on allocation failure (not memory-deduced-qualified)
+    inline auto virtual_page_add_transfer_waiter(Table& table, size_t page_idx, virtual_page_state_t state, TransferWaiter waiter) -> bool{
+
+        auto& shard = table.transfer_waiter_shard_list[page_idx % TRANSFER_WAITER_SHARD_COUNT];
+
+        {
+            std::lock_guard<std::mutex> lck_grd(shard.mtx);
+            shard.waiter_map[page_idx].push_back(waiter);
+        }
+
+        dg_atomic_fetch_add(table.transfer_waiter_count, size_t{1}, std::memory_order_seq_cst); //seq_cst pairs with virtual_page_release_transfer - either the publisher sees the waiter or the waiter sees the published state
+
+        if (virtual_page_load_state(table, page_idx, std::memory_order_seq_cst) == state){
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lck_grd(shard.mtx);
+        auto it = shard.waiter_map.find(page_idx);
+
+        if (it == shard.waiter_map.end()){
+            return true; //drained meanwhile - posted by the publisher
+        }
+
+        auto waiter_it = std::find_if(it->second.begin(), it->second.end(), [&](const TransferWaiter& cur){return cur.arg == waiter.arg;});
+
+        if (waiter_it == it->second.end()){
+            return true;
         }
 
-        size_t idx          = std::distance(static_cast<const char *>(config.translator_addr), static_cast<const char *>(ptr));
-        size_t page_slot    = slot(idx, PAGE_SZ);
-        virtual_page_sync(page_slot);
+        it->second.erase(waiter_it);
+
+        if (it->second.empty()){
+            shard.waiter_map.erase(it);
+        }
+
+        dg_atomic_fetch_sub(table.transfer_waiter_count, size_t{1}, std::memory_order_relaxed);
+        return false;
     }
 
-    inline void flush() noexcept{
+    //release the atomic_flag (transfer_state or loading_state) of the page_idx virtual page with state + wake the parked waiters + post the TransferWaiters (not memory-deduced-qualified (void))
+    //the linked bit is flipped before the publish - it is only flipped by the transfer_state owner, so a page is never linked with its bit clear
+    inline void virtual_page_release_transfer(Table& table, size_t page_idx, virtual_page_state_t state) noexcept{
+
+        auto& word      = virtual_page_linked_word(table, page_idx);
+        uint64_t mask   = uint64_t{1u} << (page_idx % LINKED_BITMAP_WORD_BITCOUNT);
+        bool is_linked  = (dg_atomic_load(word, std::memory_order_relaxed) & mask) != 0u; //skip the rmw if unchanged (sync, failed link)
+
+        if (state == virtual_page_null_state && is_linked){
+            dg_atomic_fetch_and(word, ~mask, std::memory_order_relaxed);
+        } else if (state != virtual_page_null_state && !is_linked){
+            dg_atomic_fetch_or(word, mask, std::memory_order_relaxed);
+        }
+
+        dg_atomic_exchange(virtual_page_state(table, page_idx), state, std::memory_order_seq_cst);
 
-        virtual_page_drop_all();
+        if (dg_atomic_load(table.parked_waiter_count, std::memory_order_seq_cst) != 0u){
+            dg_atomic_notify_all(virtual_page_state(table, page_idx));
+        }
+
+        if (dg_atomic_load(table.transfer_waiter_count, std::memory_order_seq_cst) != 0u){
+            virtual_page_wake_transfer_waiter(table, page_idx);
+        }
     }
 
-    inline void sync() noexcept{
+    //announce a write back before the cmpexch to transfer_state, so an acquisition that observes the transfer_state also observes the write back (not memory-deduced-qualified)
+    inline void virtual_page_write_back_begin(Table& table) noexcept{
 
-        virtual_page_sync_all();
+        dg_atomic_fetch_add(table.write_back_inflight, size_t{1}, std::memory_order_seq_cst);
     }
 
-    inline auto remap(void * old_ptr, void * old_mapped_ptr, void * new_ptr) -> void *{
+    //the write back did not happen (failed cmpexch)
+    inline void virtual_page_write_back_cancel(Table& table) noexcept{
+
+        dg_atomic_fetch_sub(table.write_back_inflight, size_t{1}, std::memory_order_seq_cst);
+    }
+
+    //the write back completed + the state is published - progress is visible through eviction_epoch before the write back retires
+    inline void virtual_page_write_back_end(Table& table) noexcept{
 
-        //consider branchless - should be compiler's optimization work in the future(if not already now) 
-        if (slot(reinterpret_cast<uintptr_t>(old_ptr), PAGE_SZ) == slot(reinterpret_cast<uintptr_t>(new_ptr), PAGE_SZ)){ 
-            return static_cast<char *>(old_mapped_ptr) + std::distance(static_cast<const char *>(old_ptr), static_cast<const char *>(new_ptr)); //UB
+        dg_atomic_fetch_add(table.eviction_epoch, size_t{1}, std::memory_order_seq_cst);
+        dg_atomic_fetch_sub(table.write_back_inflight, size_t{1}, std::memory_order_seq_cst);
+    }
+
+    //transfer_state or loading_state - owned by a transferring thread, neither linked nor null
+    constexpr auto virtual_page_is_transfer(virtual_page_state_t state) noexcept -> bool{
+
+        return state == virtual_page_transfer_state || state == virtual_page_loading_state;
+    }
+
+    //make virtual_page state from page_idx + counter + flags. a valid page_state is not null_state, transfer_state or loading_state
+    constexpr auto virtual_page_make(size_t page_idx, size_t counter, virtual_page_state_t flags = 0u) noexcept -> virtual_page_state_t{
+
+        return (static_cast<virtual_page_state_t>(page_idx + 1) << (REF_BITCOUNT + FLAG_BITCOUNT)) | flags | static_cast<virtual_page_state_t>(counter);
+    } 
+
+    //extract idx from a valid page_state
+    constexpr auto virtual_page_extract_idx(virtual_page_state_t state) noexcept -> size_t{
+
+        return (state >> (REF_BITCOUNT + FLAG_BITCOUNT)) - 1;
+    } 
+
+    //extract flags from a valid page_state
+    constexpr auto virtual_page_extract_flags(virtual_page_state_t state) noexcept -> virtual_page_state_t{
+
+        return state & (low<virtual_page_state_t>(std::integral_constant<size_t, FLAG_BITCOUNT>{}) << REF_BITCOUNT);
+    }
+
+    //extract counter from a valid page_state
+    constexpr auto virtual_page_extract_counter(virtual_page_state_t state) noexcept -> size_t{
+
+        return state & low<virtual_page_state_t>(std::integral_constant<size_t, REF_BITCOUNT>{});
+    }
+
+    //mark the chunks spanning [page_offs, page_offs + sz) of physical_page_idx dirty - the caller must hold a dirty reference of the linked virtual page (not memory-deduced-qualified (void))
+    inline void physical_page_mark_dirty_chunk(Table& table, size_t physical_page_idx, size_t page_offs, size_t sz) noexcept{
+
+        if (table.config.dirty_chunk_sz == 0u || sz == 0u){
+            return;
         }
 
-        void * rs = map(new_ptr);
-        unmap(old_ptr);
-        return rs;
+        size_t first_chunk = page_offs / table.config.dirty_chunk_sz;
+        size_t last_chunk  = (std::min(page_offs + sz, table.config.page_sz) - 1) / table.config.dirty_chunk_sz; 
+        auto * bitmap      = table.dirty_chunk_bitmap.get() + physical_page_idx * table.dirty_chunk_bitmap_word_per_page;
+
+        for (size_t i = first_chunk; i <= last_chunk;){
+            size_t word_idx = i / DIRTY_CHUNK_BITMAP_WORD_BITCOUNT;
+            size_t bit_idx  = i % DIRTY_CHUNK_BITMAP_WORD_BITCOUNT;
+            size_t bit_sz   = std::min(DIRTY_CHUNK_BITMAP_WORD_BITCOUNT - bit_idx, last_chunk - i + 1);
+            uint64_t mask   = (bit_sz == DIRTY_CHUNK_BITMAP_WORD_BITCOUNT ? ~uint64_t{0u} : ((uint64_t{1} << bit_sz) - 1)) << bit_idx; 
+
+            if ((dg_atomic_load(bitmap[word_idx], std::memory_order_relaxed) & mask) != mask){ //re-marking a dirty chunk does not dirty the cache line
+                dg_atomic_fetch_or(bitmap[word_idx], mask, std::memory_order_relaxed); //published by virtual_page_dec_ref
+            }
+
+            i += bit_sz;
+        }
+    }
+
+    //transfer every queued descriptor through the async device (one submit + wait) if present, the synchronous device otherwise. the exit of this function guarantees the transfers are completed (memory-deduced-qualified (void))
+    inline void transfer_batch_flush(TransferBatch& batch, mem_transfer_device_t device, const AsyncTransferDevice& async_device) noexcept{
+
+        if (batch.descriptor_sz == 0u){
+            return;
+        }
+
+        if (async_device.submit != nullptr){
+            async_device.wait(async_device.ctx, async_device.submit(async_device.ctx, batch.descriptor_list, batch.descriptor_sz));
+        } else{
+            for (size_t i = 0; i < batch.descriptor_sz; ++i){
+                device(batch.descriptor_list[i].dst, batch.descriptor_list[i].src, batch.descriptor_list[i].sz);
+            }
+        }
+
+        batch.descriptor_sz = 0u;
+    }
+
+    //queue a descriptor - flushes first if the batch is full (not memory-deduced-qualified until transfer_batch_flush)
+    inline void transfer_batch_push(TransferBatch& batch, mem_transfer_device_t device, const AsyncTransferDevice& async_device, TransferDescriptor descriptor) noexcept{
+
+        if (batch.descriptor_sz == TRANSFER_BATCH_DESCRIPTOR_SZ){
+            transfer_batch_flush(batch, device, async_device);
+        }
+
+        batch.descriptor_list[batch.descriptor_sz++] = descriptor;
+    }
+
+    //queue physical_mem_space -> virtual_mem_space of the page. only the dirty chunks are queued (coalesced into contiguous runs) if sub-page tracking is enabled
+    //the dirty chunk bitmap is cleared - the caller must hold the transfer_state of virtual_page_idx until the batch is flushed
+    inline void virtual_physical_page_sync(Table& table, size_t virtual_page_idx, size_t physical_page_idx, TransferBatch& batch) noexcept{
+
+        char * virtual_ptr              = static_cast<char *>(table.config.translator_addr) + table_index(table, virtual_page_idx);
+        char * physical_ptr             = static_cast<char *>(table.config.translatee_addr) + table_index(table, physical_page_idx);
+        mem_transfer_device_t device    = table.config.physical_to_virtual_transfer_device;
+        const auto& async_device        = table.config.physical_to_virtual_async_transfer_device;
+        auto push                       = [&](TransferDescriptor descriptor) noexcept{
+            stat_add(table, Stat::write_back_transfer);
+            stat_add(table, Stat::write_back_byte, descriptor.sz);
+            transfer_batch_push(batch, device, async_device, descriptor);
+        };
+
+        if (table.config.dirty_chunk_sz == 0u){
+            push({virtual_ptr, physical_ptr, table.config.page_sz});
+            return;
+        }
+
+        auto * bitmap       = table.dirty_chunk_bitmap.get() + physical_page_idx * table.dirty_chunk_bitmap_word_per_page;
+        size_t chunk_sz     = table.config.dirty_chunk_sz;
+        size_t chunk_count  = table.config.page_sz / chunk_sz;
+        size_t run_first    = 0u;
+        size_t run_sz       = 0u;
+
+        for (size_t i = 0; i < table.dirty_chunk_bitmap_word_per_page; ++i){
+            uint64_t word = dg_atomic_exchange(bitmap[i], uint64_t{0u}, std::memory_order_relaxed); //single ownership (transfer_state) + zero ref - nobody marks in the meantime
+
+            for (size_t j = 0; j < DIRTY_CHUNK_BITMAP_WORD_BITCOUNT && i * DIRTY_CHUNK_BITMAP_WORD_BITCOUNT + j < chunk_count; ++j){
+                size_t chunk_idx = i * DIRTY_CHUNK_BITMAP_WORD_BITCOUNT + j;
+
+                if ((word >> j) & uint64_t{1u}){
+                    run_first   = run_sz == 0u ? chunk_idx : run_first;
+                    run_sz      += 1;
+                    continue;
+                }
+
+                if (run_sz != 0u){
+                    push({virtual_ptr + index(run_first, chunk_sz), physical_ptr + index(run_first, chunk_sz), run_sz * chunk_sz});
+                    run_sz = 0u;
+                }
+            }
+        }
+
+        if (run_sz != 0u){
+            push({virtual_ptr + index(run_first, chunk_sz), physical_ptr + index(run_first, chunk_sz), run_sz * chunk_sz});
+        }
+    } 
+
+    //exhaust physical_mem_space -> virtual_mem_space  
+    inline void virtual_physical_page_sync(Table& table, size_t virtual_page_idx, size_t physical_page_idx) noexcept{
+
+        TransferBatch batch;
+        batch.descriptor_sz = 0u;
+        virtual_physical_page_sync(table, virtual_page_idx, physical_page_idx, batch);
+        transfer_batch_flush(batch, table.config.physical_to_virtual_transfer_device, table.config.physical_to_virtual_async_transfer_device);
+    }
+
+    //append the run-length stream of [src, src + sz) to dst - a record is a uint32_t header ((len << 1) | is_run) followed by the run byte or the len literal bytes
+    //false if the stream outgrows limit (dst is partially written then)
+    inline auto victim_tier_encode(const uint8_t * src, size_t sz, size_t limit, std::vector<uint8_t>& dst) -> bool{
+
+        auto push_header = [&](size_t len, bool is_run){
+            uint32_t header = static_cast<uint32_t>((len << 1) | size_t{is_run});
+            size_t offs     = dst.size();
+            dst.resize(offs + sizeof(uint32_t));
+            std::memcpy(dst.data() + offs, &header, sizeof(uint32_t));
+        };
+
+        auto push_literal = [&](size_t first, size_t last){
+            if (first == last){
+                return;
+            }
+
+            push_header(last - first, false);
+            dst.insert(dst.end(), src + first, src + last);
+        };
+
+        size_t literal_first = 0u;
+
+        for (size_t i = 0u; i < sz;){
+            size_t j = i + 1;
+
+            while (j < sz && src[j] == src[i]){
+                j += 1;
+            }
+
+            if (j - i >= VICTIM_TIER_MIN_RUN){
+                push_literal(literal_first, i);
+                push_header(j - i, true);
+                dst.push_back(src[i]);
+                literal_first = j;
+            }
+
+            i = j;
+
+            if (dst.size() + (i - literal_first) > limit){ //pending literals count - an incompressible page is rejected after limit bytes
+                return false;
+            }
+        }
+
+        push_literal(literal_first, sz);
+        return dst.size() <= limit;
+    }
+
+    //compress a page into dst - zero pages are detected first (empty dst), the others are run-length coded. false if the page does not compress to page_sz / VICTIM_TIER_MIN_RATIO
+    inline auto victim_tier_compress(const char * page, size_t page_sz, std::vector<uint8_t>& dst) -> bool{
+
+        const auto * src = reinterpret_cast<const uint8_t *>(page);
+        dst.clear();
+
+        if (src[0] == 0u && std::memcmp(src, src + 1, page_sz - 1) == 0){ //zero page
+            return true;
+        }
+
+        if (page_sz >= (size_t{1} << (sizeof(uint32_t) * CHAR_BIT - 1))){ //record len does not fit the header
+            return false;
+        }
+
+        size_t probe_sz = std::min(page_sz, VICTIM_TIER_PROBE_SZ);
+
+        if (!victim_tier_encode(src, probe_sz, probe_sz / VICTIM_TIER_MIN_RATIO, dst)){
+            return false;
+        }
+
+        dst.clear();
+        return victim_tier_encode(src, page_sz, page_sz / VICTIM_TIER_MIN_RATIO, dst);
+    }
+
+    inline void victim_tier_decompress(const std::vector<uint8_t>& data, char * page, size_t page_sz) noexcept{
+
+        if (data.empty()){
+            std::memset(page, 0, page_sz);
+            return;
+        }
+
+        for (size_t offs = 0u; offs < data.size();){
+            uint32_t header{};
+            std::memcpy(&header, data.data() + offs, sizeof(uint32_t));
+            offs        += sizeof(uint32_t);
+            size_t len  = header >> 1;
+
+            if (header & uint32_t{1u}){
+                std::memset(page, data[offs], len);
+                offs += 1;
+            } else{
+                std::memcpy(page, data.data() + offs, len);
+                offs += len;
+            }
+
+            page += len;
+        }
+    }
+
+    inline auto victim_tier_charged_sz(const VictimTierEntry& entry) noexcept -> size_t{
+
+        return entry.data.size() + VICTIM_TIER_ENTRY_OVERHEAD_SZ;
+    }
+
+    //the shard lock must be held
+    inline void victim_tier_shard_erase(VictimTierShard& shard, std::unordered_map<size_t, VictimTierEntry>::iterator it) noexcept{
+
+        shard.byte_sz -= victim_tier_charged_sz(it->second);
+        shard.lru_list.erase(it->second.lru_it);
+        shard.entry_map.erase(it);
+    }
+
+    //store physical_page_idx as the entry of the page_idx virtual page, the least recently evicted entries of the shard are dropped to make room
+    //the caller must hold the transfer_state of page_idx + the physical page must not be older than virtual memory (a write back may still be queued). best effort - incompressible pages are not stored (not memory-deduced-qualified (void))
+    inline void victim_tier_insert(Table& table, size_t page_idx, size_t physical_page_idx) noexcept{
+
+        VictimTier * tier = table.victim_tier.get();
+
+        if (tier == nullptr){
+            return;
+        }
+
+        try{
+            std::vector<uint8_t> data{};
+
+            if (!victim_tier_compress(static_cast<const char *>(table.physical_page_list[physical_page_idx].addr), table.config.page_sz, data)){
+                return;
+            }
+
+            data.shrink_to_fit(); //charged bytes are the held bytes
+            size_t charged_sz   = data.size() + VICTIM_TIER_ENTRY_OVERHEAD_SZ;
+            auto& shard         = tier->shard_list[page_idx % VICTIM_TIER_SHARD_COUNT];
+
+            if (charged_sz > tier->shard_capacity){
+                return;
+            }
+
+            std::lock_guard<std::mutex> lck_grd(shard.mtx);
+
+            if (auto it = shard.entry_map.find(page_idx); it != shard.entry_map.end()){
+                victim_tier_shard_erase(shard, it);
+            }
+
+            while (shard.byte_sz + charged_sz > tier->shard_capacity){
+                victim_tier_shard_erase(shard, shard.entry_map.find(shard.lru_list.back()));
+            }
+
+            shard.lru_list.push_front(page_idx);
+
+            try{
+                shard.entry_map.emplace(page_idx, VictimTierEntry{std::move(data), shard.lru_list.begin()});
+            } catch (...){
+                shard.lru_list.pop_front();
+                throw;
+            }
+
+            shard.byte_sz += charged_sz;
+            stat_add(table, Stat::victim_tier_insert);
+        } catch (...){} //allocation failure - the page is simply not kept
+    }
+
+    //fill physical_page_idx from the entry of the page_idx virtual page + erase the entry - false if there is none. the caller must hold the transfer_state of page_idx (memory-deduced-qualified if true)
+    inline auto victim_tier_try_take(Table& table, size_t page_idx, size_t physical_page_idx) noexcept -> bool{
+
+        VictimTier * tier = table.victim_tier.get();
+
+        if (tier == nullptr){
+            return false;
+        }
+
+        auto& shard = tier->shard_list[page_idx % VICTIM_TIER_SHARD_COUNT];
+        std::vector<uint8_t> data{};
+
+        {
+            std::lock_guard<std::mutex> lck_grd(shard.mtx);
+            auto it = shard.entry_map.find(page_idx);
+
+            if (it == shard.entry_map.end()){
+                return false;
+            }
+
+            shard.byte_sz -= victim_tier_charged_sz(it->second);
+            data = std::move(it->second.data); //decompressed outside of the lock
+            shard.lru_list.erase(it->second.lru_it);
+            shard.entry_map.erase(it);
+        }
+
+        victim_tier_decompress(data, static_cast<char *>(table.physical_page_list[physical_page_idx].addr), table.config.page_sz);
+        stat_add(table, Stat::victim_tier_hit);
+
+        return true;
+    }
+
+    //drop the entry of the page_idx virtual page - virtual memory of the page may then be changed outside of the TLB
+    inline void victim_tier_erase(Table& table, size_t page_idx) noexcept{
+
+        VictimTier * tier = table.victim_tier.get();
+
+        if (tier == nullptr){
+            return;
+        }
+
+        auto& shard = tier->shard_list[page_idx % VICTIM_TIER_SHARD_COUNT];
+        std::lock_guard<std::mutex> lck_grd(shard.mtx);
+
+        if (auto it = shard.entry_map.find(page_idx); it != shard.entry_map.end()){
+            victim_tier_shard_erase(shard, it);
+        }
+    }
+
+    //drop every entry
+    inline void victim_tier_clear(Table& table) noexcept{
+
+        VictimTier * tier = table.victim_tier.get();
+
+        if (tier == nullptr){
+            return;
+        }
+
+        for (auto& shard: tier->shard_list){
+            std::lock_guard<std::mutex> lck_grd(shard.mtx);
+            shard.entry_map.clear();
+            shard.lru_list.clear();
+            shard.byte_sz = 0u;
+        }
+    }
+
+    //transfer virtual_mem_space -> physical_mem_space - decompressed from the victim tier if the page has an entry
+    inline void physical_virtual_page_sync(Table& table, size_t physical_page_idx, size_t virtual_page_idx) noexcept{
+
+        if (victim_tier_try_take(table, virtual_page_idx, physical_page_idx)){
+            return;
+        }
+
+        char * physical_ptr = static_cast<char *>(table.config.translatee_addr) + table_index(table, physical_page_idx);
+        char * virtual_ptr  = static_cast<char *>(table.config.translator_addr) + table_index(table, virtual_page_idx);
+        const auto& async_device = table.config.virtual_to_physical_async_transfer_device;
+        stat_add(table, Stat::fill_transfer);
+        stat_add(table, Stat::fill_byte, table.config.page_sz);
+
+        if (async_device.submit != nullptr){
+            TransferDescriptor descriptor{physical_ptr, virtual_ptr, table.config.page_sz};
+            async_device.wait(async_device.ctx, async_device.submit(async_device.ctx, &descriptor, 1u)); //the device may split the page across workers
+            return;
+        }
+
+        table.config.virtual_to_physical_transfer_device(physical_ptr, static_cast<const void *>(virtual_ptr), table.config.page_sz);
+    } 
+
+    //try release a page - true if successfully released (memory-deduced-qualified, false otherwise (not memory-deduced-qualified) 
+    inline auto virtual_page_try_release_if_zero_ref(Table& table, size_t page_idx) noexcept -> bool{
+
+        while (true){
+            auto state = virtual_page_load_state(table, page_idx, std::memory_order_acquire); //atomic_load as an unfair randomizer
+
+            if (state == virtual_page_null_state){
+                return true;
+            }
+            
+            if (virtual_page_is_transfer(state)){
+                return false;
+            }
+
+            size_t physical_page_idx = virtual_page_extract_idx(state);
+            size_t counter = virtual_page_extract_counter(state);
+            
+            if (counter != 0u){
+                return false;
+            }
+
+            if ((virtual_page_extract_flags(state) & virtual_page_dirty_flag) == 0u){
+                if (dg_compare_exchange_strong(virtual_page_state(table, page_idx), state, virtual_page_transfer_state, std::memory_order_acq_rel)){ //clean - virtual memory is up-to-date, unlink without transfer (through transfer_state for the linked bit)
+                    virtual_page_release_transfer(table, page_idx, virtual_page_null_state);
+                    physical_page_release(table, physical_page_idx);
+                    dg_atomic_thread_fence(std::memory_order_acquire);
+                    return true;
+                }
+
+                continue;
+            }
+
+            virtual_page_write_back_begin(table);
+
+            if (dg_compare_exchange_strong(virtual_page_state(table, page_idx), state, virtual_page_transfer_state, std::memory_order_acq_rel)){ //try acquiring atomic_flag from valid state (acq_rel is mandatory because of unfair randomizer, not mandatory otherwise (version_control))
+                virtual_physical_page_sync(table, page_idx, physical_page_idx); //transfers memory as permission granted
+                virtual_page_release_transfer(table, page_idx, virtual_page_null_state); //release atomic_flag + defaultize (because of injective req + single ownership, up-to-date + mem-safe req are met)
+                physical_page_release(table, physical_page_idx); //release physical_page, mem_safe req is met (release after null_state for symmetry, as initialized)
+                virtual_page_write_back_end(table);
+                dg_atomic_thread_fence(std::memory_order_acquire);
+                return true;
+            }
+
+            virtual_page_write_back_cancel(table);
+        }
+    }   
+
+    //try synchronize a page - true if successfully synchronized (...), false otherwise (...). true denotes the at-the-time page is up-to-date.   
+    inline auto virtual_page_try_sync(Table& table, size_t page_idx) noexcept -> bool{
+
+        while (true){
+            auto state = virtual_page_load_state(table, page_idx, std::memory_order_acquire); //atomic load as an unfair randomizer
+
+            if (state == virtual_page_null_state){
+                return true;
+            }
+            
+            if (virtual_page_is_transfer(state)){
+                return false;
+            }
+
+            if ((virtual_page_extract_flags(state) & virtual_page_dirty_flag) == 0u){ //clean - nothing to write back, regardless of readers
+                return true;
+            }
+
+            size_t physical_page_idx = virtual_page_extract_idx(state);
+            size_t counter = virtual_page_extract_counter(state);
+            
+            if (counter != 0u){
+                return false;
+            }
+
+            virtual_page_write_back_begin(table);
+
+            if (dg_compare_exchange_strong(virtual_page_state(table, page_idx), state, virtual_page_transfer_state, std::memory_order_acq_rel)){ //try acquiring atomic_flag from valid state (acq_rel is mandatory because of unfair randomizer, not mandatory otherwise (version_control))
+                virtual_physical_page_sync(table, page_idx, physical_page_idx); //transfers memory as permission granted
+                virtual_page_release_transfer(table, page_idx, state & ~virtual_page_dirty_flag); //release atomic_flag + snap back to org_state - clean (should obey the rules as others are immutable during atomic_flag acquisition - single ownership rule)
+                virtual_page_write_back_end(table);
+                dg_atomic_thread_fence(std::memory_order_acquire);
+                return true;
+            }
+
+            virtual_page_write_back_cancel(table);
+        } 
+    } 
+
+    //try evict the page_idx virtual page if it is linked to physical_page_idx + zero ref + not referenced (clears the reference bit otherwise - second chance)
+    //true if evicted - the physical page stays acquired and is handed to the caller (memory-deduced-qualified), false otherwise (not memory-deduced-qualified)
+    inline auto virtual_page_try_evict(Table& table, size_t page_idx, size_t physical_page_idx) noexcept -> bool{
+
+        auto state = virtual_page_load_state(table, page_idx, std::memory_order_acquire);
+
+        if (state == virtual_page_null_state || virtual_page_is_transfer(state)){
+            return false;
+        }
+
+        if (virtual_page_extract_idx(state) != physical_page_idx || virtual_page_extract_counter(state) != 0u){
+            return false;
+        }
+
+        if (virtual_page_extract_flags(state) & virtual_page_referenced_flag){
+            dg_compare_exchange_strong(virtual_page_state(table, page_idx), state, state & ~virtual_page_referenced_flag, std::memory_order_relaxed); //best effort - a failed cmpexch means the page is in use
+            return false;
+        }
+
+        if ((virtual_page_extract_flags(state) & virtual_page_dirty_flag) == 0u){
+            if (dg_compare_exchange_strong(virtual_page_state(table, page_idx), state, virtual_page_transfer_state, std::memory_order_acq_rel)){ //clean - unlink without transfer (through transfer_state for the linked bit)
+                victim_tier_insert(table, page_idx, physical_page_idx);
+                virtual_page_release_transfer(table, page_idx, virtual_page_null_state);
+                dg_atomic_fetch_add(table.eviction_epoch, size_t{1}, std::memory_order_relaxed);
+                dg_atomic_thread_fence(std::memory_order_acquire);
+                return true;
+            }
+
+            return false;
+        }
+
+        virtual_page_write_back_begin(table);
+
+        if (dg_compare_exchange_strong(virtual_page_state(table, page_idx), state, virtual_page_transfer_state, std::memory_order_acq_rel)){ //try acquiring atomic_flag from valid state - same as virtual_page_try_release_if_zero_ref
+            virtual_physical_page_sync(table, page_idx, physical_page_idx);
+            victim_tier_insert(table, page_idx, physical_page_idx);
+            virtual_page_release_transfer(table, page_idx, virtual_page_null_state); //physical_page is not released - ownership is transferred to the caller
+            virtual_page_write_back_end(table);
+            dg_atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+
+        virtual_page_write_back_cancel(table);
+        return false;
+    }
+
+    //try write back every zero-ref dirty page of [first, last) - up to TRANSFER_BATCH_PAGE_SZ pages are held in transfer_state and transferred in one batch, so the write backs overlap on an async device
+    //is_unlink unlinks + releases the written back pages (and the zero-ref clean pages), clears the dirty bit otherwise. referenced or in-transfer pages are skipped (not memory-deduced-qualified)
+    //is_victim (with is_unlink) keeps the unlinked pages in the victim tier - an eviction, not a drop
+    inline void virtual_page_batch_write_back(Table& table, bool is_unlink, size_t first, size_t last, bool is_victim = false) noexcept{
+
+        size_t claimed_page_list[TRANSFER_BATCH_PAGE_SZ];
+        virtual_page_state_t claimed_state_list[TRANSFER_BATCH_PAGE_SZ];
+        size_t claimed_sz = 0u;
+        TransferBatch batch;
+        batch.descriptor_sz = 0u;
+
+        auto publish = [&]() noexcept{
+            transfer_batch_flush(batch, table.config.physical_to_virtual_transfer_device, table.config.physical_to_virtual_async_transfer_device);
+
+            for (size_t i = 0; i < claimed_sz; ++i){
+                if (is_unlink){
+                    virtual_page_release_transfer(table, claimed_page_list[i], virtual_page_null_state); //same as virtual_page_try_release_if_zero_ref
+                    physical_page_release(table, virtual_page_extract_idx(claimed_state_list[i]));
+                } else{
+                    virtual_page_release_transfer(table, claimed_page_list[i], claimed_state_list[i] & ~virtual_page_dirty_flag); //same as virtual_page_try_sync
+                }
+
+                virtual_page_write_back_end(table);
+            }
+
+            claimed_sz = 0u;
+        };
+
+        for (size_t i = virtual_page_next_linked(table, first, last); i < last; i = virtual_page_next_linked(table, i + 1, last)){
+            auto state = virtual_page_load_state(table, i, std::memory_order_acquire);
+
+            if (state == virtual_page_null_state || virtual_page_is_transfer(state) || virtual_page_extract_counter(state) != 0u){
+                continue;
+            }
+
+            if ((virtual_page_extract_flags(state) & virtual_page_dirty_flag) == 0u){
+                if (is_unlink && dg_compare_exchange_strong(virtual_page_state(table, i), state, virtual_page_transfer_state, std::memory_order_acq_rel)){
+                    if (is_victim){
+                        victim_tier_insert(table, i, virtual_page_extract_idx(state));
+                    }
+
+                    virtual_page_release_transfer(table, i, virtual_page_null_state);
+                    physical_page_release(table, virtual_page_extract_idx(state));
+                }
+
+                continue;
+            }
+
+            virtual_page_write_back_begin(table);
+
+            if (!dg_compare_exchange_strong(virtual_page_state(table, i), state, virtual_page_transfer_state, std::memory_order_acq_rel)){
+                virtual_page_write_back_cancel(table);
+                continue;
+            }
+
+            claimed_page_list[claimed_sz]   = i;
+            claimed_state_list[claimed_sz]  = state;
+            claimed_sz                      += 1;
+            virtual_physical_page_sync(table, i, virtual_page_extract_idx(state), batch);
+
+            if (is_unlink && is_victim){
+                victim_tier_insert(table, i, virtual_page_extract_idx(state));
+            }
+
+            if (claimed_sz == TRANSFER_BATCH_PAGE_SZ){
+                publish();
+            }
+        }
+
+        publish();
+        dg_atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    //try release all available pages (not memory-deduced-qualified)
+    inline void virtual_page_release_zero_ref(Table& table) noexcept{
+
+        virtual_page_batch_write_back(table, true, 0u, table.virtual_page_list_sz, true);
+    }
+
+    //advance the clock hand of the partition of node until a victim is evicted - at most two revolutions (first revolution clears reference bits, second evicts). return memory-deduced-qualified physical_page_idx if found, nullopt otherwise (every page is pinned)
+    //pages sitting in the free lists are not linked - they fail the back-pointer check of virtual_page_try_evict
+    inline auto physical_page_clock_evict(Table& table, size_t node) noexcept -> std::optional<size_t>{
+
+        size_t first            = numa_partition_first(table.physical_page_list_sz, table.numa_node_count, node);
+        size_t partition_sz     = numa_partition_first(table.physical_page_list_sz, table.numa_node_count, node + 1) - first;
+        size_t revolution_sz    = partition_sz * 2u;
+
+        for (size_t i = 0; i < revolution_sz; ++i){
+            size_t physical_page_idx = first + dg_atomic_fetch_add(table.clock_hand_list[node].hand, size_t{1}, std::memory_order_relaxed) % partition_sz;
+            size_t virtual_page_idx = dg_atomic_load(table.physical_page_list[physical_page_idx].virtual_page_idx, std::memory_order_relaxed); 
+
+            if (virtual_page_try_evict(table, virtual_page_idx, physical_page_idx)){
+                stat_add(table, Stat::clock_evict);
+                stat_add_numa_acquire(table, physical_page_idx);
+                return physical_page_idx;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    //evict from the local partition first, then from the remote ones (same order as physical_page_try_acquire_empty)
+    inline auto physical_page_clock_evict(Table& table) noexcept -> std::optional<size_t>{
+
+        size_t local_node = numa_local_node(table);
+
+        for (size_t i = 0; i < table.numa_node_count; ++i){
+            if (auto rs = physical_page_clock_evict(table, (local_node + i) % table.numa_node_count); rs){
+                return rs;
+            }
+        }
+
+        return std::nullopt;
+    }
+    
+    inline void thread_cache_revoke_all(Table& table) noexcept;
+
+    //try acquire an empty page - if failed - evict + retry. If succeeded - return memory-deduced-qualified physical_page_idx. If throw, throw memory-deduced-qualified no_page_found 
+    inline auto physical_page_force_acquire_empty(Table& table) -> size_t{
+
+        if (auto rs = physical_page_try_acquire_empty(table); rs){
+            return rs.value();
+        }
+
+        bool is_pressured = false;
+        size_t round      = 0u;
+
+        while (true){
+            size_t epoch            = dg_atomic_load(table.eviction_epoch, std::memory_order_relaxed);
+            std::optional<size_t> rs{};
+
+            if (table.config.eviction_policy == EvictionPolicy::flush_zero_ref){
+                stat_add(table, Stat::release_zero_ref_fallback);
+                virtual_page_release_zero_ref(table);
+                rs = physical_page_try_acquire_empty(table);
+            } else{
+                rs = physical_page_clock_evict(table);
+
+                if (!rs){
+                    rs = physical_page_try_acquire_empty(table); //pages released during the sweep
+                }
+            }
+
+            if (rs){
+                if (is_pressured){
+                    dg_atomic_exchange(table.thread_cache_pressure, false, std::memory_order_relaxed);
+                }
+
+                return rs.value();
+            }
+
+            if (table.config.thread_cache_enabled){
+                is_pressured = true;
+                dg_atomic_exchange(table.thread_cache_pressure, true, std::memory_order_relaxed);
+                thread_cache_revoke_all(table);
+            }
+
+            if (dg_atomic_load(table.write_back_inflight, std::memory_order_seq_cst) != 0u){ //pages in write back are neither evictable nor pinned - retry once they are published
+                backoff(round);
+                continue;
+            }
+
+            if (dg_atomic_load(table.eviction_epoch, std::memory_order_seq_cst) == epoch){ //nothing was evicted, released, written back or revoked by anyone during the attempt - every page is pinned by users
+                break;
+            }
+        }
+
+        stat_add(table, Stat::no_page_found);
+        dg_atomic_thread_fence(std::memory_order_acquire);
+        throw no_page_found();
+    } 
+
+    //try establish linkage to physical_page and increment reference of page_idx virtual page - return the at-the-time linked addr (memory-deduced-qualified if non-null, not qualified otherwise). The at-the-time pointer lifetime is guaranteed up-to the invoke of virtual_page_dec_ref.
+    //access_flags is virtual_page_dirty_flag for writable mappings, 0 for read-only mappings
+    inline auto virtual_page_try_link_n_inc_ref(Table& table, size_t page_idx, virtual_page_state_t access_flags, size_t ref_count = 1u) -> void *{
+
+        //claim before transfer - a fill before the claim could race with evict + relink of page_idx and publish stale memory (null_state -> null_state ABA). the concurrent misses of page_idx fail the claim + wait for this fill
+        if (!dg_compare_exchange_strong(virtual_page_state(table, page_idx), virtual_page_null_state, virtual_page_loading_state, std::memory_order_acq_rel)){
+            stat_add(table, Stat::link_claim_fail);
+            return nullptr;
+        }
+
+        size_t physical_page_idx{};
+
+        try{
+            physical_page_idx = physical_page_force_acquire_empty(table);
+        } catch (...){
+            virtual_page_release_transfer(table, page_idx, virtual_page_null_state); //release atomic_flag - nothing is transferred
+            throw;
+        }
+
+        auto flags  = (table.config.eviction_policy == EvictionPolicy::clock_cold_insert ? virtual_page_state_t{0u} : virtual_page_referenced_flag) | access_flags;
+        auto state  = virtual_page_make(physical_page_idx, ref_count, flags);
+        physical_virtual_page_sync(table, physical_page_idx, page_idx);
+        dg_atomic_exchange(table.physical_page_list[physical_page_idx].virtual_page_idx, page_idx, std::memory_order_relaxed); //hint is published by the release below
+        virtual_page_release_transfer(table, page_idx, state); //release atomic_flag + link
+        stat_add(table, Stat::map_miss);
+
+        return table.physical_page_list[physical_page_idx].addr;
+    }
+
+    //try map virtual_page to the linked physical_page + inc reference - return the at-the-time mapped addr (memory-deduced-qualified if non-null, not qualified otherwise). The at-the-time pointer lifetime is guaranteed up-to the invoke of virtual_page_dec_ref.
+    //ref_count references are taken with one cmpexch. throw reference_overflow if the page would hold more than VIRTUAL_PAGE_MAX_REF references - the state is untouched
+    inline auto virtual_page_try_map_n_inc_ref_if_exists(Table& table, size_t page_idx, virtual_page_state_t access_flags, size_t ref_count = 1u) -> void *{
+
+        size_t round        = 0u;
+        bool is_coalesced   = false; //waited for a fill - this map attaches to it
+
+        while (true){
+            auto cur_state      = virtual_page_load_state(table, page_idx, std::memory_order_acquire);
+            
+            if (cur_state == virtual_page_null_state){
+                return nullptr;
+            }
+
+            if (virtual_page_is_transfer(cur_state)){
+                is_coalesced = is_coalesced || cur_state == virtual_page_loading_state;
+                stat_add(table, Stat::map_cas_retry);
+                virtual_page_wait_transfer(table, page_idx, cur_state, round);
+                continue;
+            }
+
+            size_t idx          = virtual_page_extract_idx(cur_state);
+            size_t counter      = virtual_page_extract_counter(cur_state);
+            auto flags          = virtual_page_extract_flags(cur_state) | virtual_page_referenced_flag | access_flags; //reference + dirty bits come for free with the cmpexch
+
+            if (ref_count > VIRTUAL_PAGE_MAX_REF - counter){
+                throw reference_overflow();
+            }
+
+            auto nxt_state      = virtual_page_make(idx, counter + ref_count, flags);
+            
+            if (dg_compare_exchange_strong(virtual_page_state(table, page_idx), cur_state, nxt_state, std::memory_order_acq_rel)){
+                stat_add(table, is_coalesced ? Stat::link_coalesced : Stat::map_hit);
+                return table.physical_page_list[idx].addr;
+            }
+
+            stat_add(table, Stat::map_cas_retry);
+        }
+    }
+
+    //same as virtual_page_try_map_n_inc_ref_if_exists without waiting - null if the page is null or in transfer (not memory-deduced-qualified then)
+    inline auto virtual_page_try_map_n_inc_ref_if_linked(Table& table, size_t page_idx, virtual_page_state_t access_flags, size_t ref_count = 1u) -> void *{
+
+        while (true){
+            auto cur_state      = virtual_page_load_state(table, page_idx, std::memory_order_acquire);
+
+            if (cur_state == virtual_page_null_state || virtual_page_is_transfer(cur_state)){
+                return nullptr;
+            }
+
+            size_t idx          = virtual_page_extract_idx(cur_state);
+            size_t counter      = virtual_page_extract_counter(cur_state);
+            auto flags          = virtual_page_extract_flags(cur_state) | virtual_page_referenced_flag | access_flags;
+
+            if (ref_count > VIRTUAL_PAGE_MAX_REF - counter){
+                throw reference_overflow();
+            }
+
+            if (dg_compare_exchange_strong(virtual_page_state(table, page_idx), cur_state, virtual_page_make(idx, counter + ref_count, flags), std::memory_order_acq_rel)){
+                stat_add(table, Stat::map_hit);
+                return table.physical_page_list[idx].addr;
+            }
+
+            stat_add(table, Stat::map_cas_retry);
+        }
+    }
+
+    //try link the page_idx virtual page without taking a reference - the page is clean + zero-ref + not referenced, so it is the first eviction candidate until it is mapped
+    //never waits - only a free physical page (or a CLOCK victim) is used, true if page_idx is linked or in transfer at exit (not memory-deduced-qualified)
+    inline auto virtual_page_try_prefetch(Table& table, size_t page_idx) noexcept -> bool{
+
+        if (!dg_compare_exchange_strong(virtual_page_state(table, page_idx), virtual_page_null_state, virtual_page_loading_state, std::memory_order_acq_rel)){
+            return true;
+        }
+
+        std::optional<size_t> physical_page_idx = physical_page_try_acquire_empty(table);
+
+        if (!physical_page_idx && table.config.eviction_policy != EvictionPolicy::flush_zero_ref){
+            physical_page_idx = physical_page_clock_evict(table);
+        }
+
+        if (!physical_page_idx){
+            virtual_page_release_transfer(table, page_idx, virtual_page_null_state); //release atomic_flag - nothing is transferred
+            return false;
+        }
+
+        physical_virtual_page_sync(table, physical_page_idx.value(), page_idx);
+        dg_atomic_exchange(table.physical_page_list[physical_page_idx.value()].virtual_page_idx, page_idx, std::memory_order_relaxed);
+        virtual_page_release_transfer(table, page_idx, virtual_page_make(physical_page_idx.value(), 0u)); //release atomic_flag + link, zero ref
+        stat_add(table, Stat::prefetch_link);
+
+        return true;
+    }
+
+    struct PrefetchTask{
+        Table * table;
+        size_t first;
+        size_t last;
+        size_t stride;
+    };
+
+    inline void prefetch_task_run(void * arg) noexcept{
+
+        auto * task = static_cast<PrefetchTask *>(arg);
+        Table& table = *task->table;
+
+        for (size_t i = task->first; i != task->last; i += task->stride){
+            if (!virtual_page_try_prefetch(table, i)){ //out of free + evictable pages - the remaining pages would evict the ones just prefetched
+                break;
+            }
+        }
+
+        delete task;
+        dg_atomic_fetch_sub(table.prefetch_inflight, size_t{1}, std::memory_order_release);
+    }
+
+    //prefetch count pages first, first + stride, ... (stride in two's complement, the pages must lie in the table) on the prefetch executor if present, the calling thread otherwise (not memory-deduced-qualified (void))
+    inline void virtual_page_prefetch(Table& table, size_t first, size_t count, size_t stride) noexcept{
+
+        if (count == 0u){
+            return;
+        }
+
+        auto * task = new (std::nothrow) PrefetchTask{&table, first, first + count * stride, stride};
+
+        if (!task){
+            return; //best effort
+        }
+
+        dg_atomic_fetch_add(table.prefetch_inflight, size_t{1}, std::memory_order_relaxed);
+
+        if (table.config.prefetch_executor.post == nullptr || !table.config.prefetch_executor.post(table.config.prefetch_executor.ctx, prefetch_task_run, task)){
+            prefetch_task_run(task);
+        }
+    }
+
+    //wait for the posted prefetches to retire (memory-deduced-qualified (void))
+    inline void virtual_page_prefetch_wait(Table& table) noexcept{
+
+        size_t round = 0u;
+
+        while (dg_atomic_load(table.prefetch_inflight, std::memory_order_acquire) != 0u){
+            backoff(round);
+        }
+    }
+
+    //miss path detector - a miss at page_idx that repeats the stride of the previous miss reads ahead readahead_page_count pages along the stride. misses of concurrent scans interleave, a broken pattern only costs the readahead
+    inline void virtual_page_readahead(Table& table, size_t page_idx) noexcept{
+
+        if (table.config.readahead_page_count == 0u){
+            return;
+        }
+
+        size_t last_slot = dg_atomic_exchange(table.readahead_last_slot, page_idx + 1, std::memory_order_relaxed);
+
+        if (last_slot == 0u){
+            return;
+        }
+
+        size_t stride       = page_idx - (last_slot - 1); //two's complement
+        size_t last_stride  = dg_atomic_exchange(table.readahead_stride, stride, std::memory_order_relaxed);
+
+        if (stride != last_stride || stride == 0u){
+            return;
+        }
+
+        size_t count = 0u;
+
+        for (size_t i = page_idx + stride; count < table.config.readahead_page_count && i < table.virtual_page_list_sz; i += stride){ //a negative stride wraps past virtual_page_list_sz
+            count += 1;
+        }
+
+        stat_add(table, Stat::readahead);
+        virtual_page_prefetch(table, page_idx + stride, count, stride);
+    }
+
+    //force map (link if necessary). return the non-null at-the-time mapped_addr (memory-deduced-qualified). throw no_page_found if the at-the-time linkage could not be established, reference_overflow if the page holds VIRTUAL_PAGE_MAX_REF references. The at-the-time pointer lifetime is guaranteed up-to the invoke of virtual_page_dec_ref.
+    inline auto virtual_page_force_fetch_n_inc_ref(Table& table, size_t page_idx, virtual_page_state_t access_flags, size_t ref_count = 1u) -> void *{
+
+        size_t first_timestamp = stat_timestamp();
+
+        while (true){
+            if (void * rs = virtual_page_try_map_n_inc_ref_if_exists(table, page_idx, access_flags, ref_count); rs){
+                return rs;
+            }
+
+            if (void * rs = virtual_page_try_link_n_inc_ref(table, page_idx, access_flags, ref_count); rs){
+                stat_record_miss_latency(table, first_timestamp);
+                virtual_page_readahead(table, page_idx);
+                return rs;
+            }
+        }
+    }
+
+    //mark the page_idx virtual_page dirty. the caller must hold a reference (not memory-deduced-qualified (void))
+    inline void virtual_page_mark_dirty(Table& table, size_t page_idx) noexcept{
+
+        while (true){
+            auto cur_state = virtual_page_load_state(table, page_idx, std::memory_order_relaxed);
+
+            if (virtual_page_extract_flags(cur_state) & virtual_page_dirty_flag){
+                return;
+            }
+
+            if (dg_compare_exchange_strong(virtual_page_state(table, page_idx), cur_state, cur_state | virtual_page_dirty_flag, std::memory_order_relaxed)){
+                return;
+            }
+        }
+    }
+
+    //decrease ref_count references of the page_idx virtual_page (not memory-deduced-qualified (void)). abort if the page holds fewer (unbalanced unmap)
+    inline void virtual_page_dec_ref(Table& table, size_t page_idx, size_t ref_count = 1u) noexcept{
+
+        size_t round = 0u;
+
+        while (true){
+            auto cur_state      = virtual_page_load_state(table, page_idx, std::memory_order_acquire);
+
+            if (cur_state == virtual_page_null_state){ //unmap without a map - no reference to drop
+                return;
+            }
+
+            if (virtual_page_is_transfer(cur_state)){
+                stat_add(table, Stat::dec_ref_cas_retry);
+                virtual_page_wait_transfer(table, page_idx, cur_state, round);
+                continue;
+            }
+
+            size_t idx          = virtual_page_extract_idx(cur_state);
+            size_t counter      = virtual_page_extract_counter(cur_state);
+            auto flags          = virtual_page_extract_flags(cur_state);
+
+            if (counter < ref_count){ //unbalanced unmap - the counter would wrap into the flags + idx
+                std::abort();
+            }
+
+            auto new_state      = virtual_page_make(idx, counter - ref_count, flags); 
+
+            if (dg_compare_exchange_strong(virtual_page_state(table, page_idx), cur_state, new_state, std::memory_order_release)){ //no guarantee that state is the same at load and cmp_exchg_strong. atomic_load as an unfair randomizer
+                return;
+            }
+
+            stat_add(table, Stat::dec_ref_cas_retry);
+        }
+    }
+
+    //map the distinct virtual pages of slot_list - addr_list[i] is the at-the-time mapped addr of slot_list[i], ref_list[i] references are taken with one cmpexch
+    //linked pages are mapped first, then the misses are claimed + linked together - the fills of up to TRANSFER_BATCH_PAGE_SZ pages (a quarter of the pool at most) are submitted as one transfer batch
+    //throw no_page_found / reference_overflow if a page could not be mapped - every reference taken by the call is dropped before the throw. same lifetime guarantees as virtual_page_force_fetch_n_inc_ref
+    inline void virtual_page_batch_fetch_n_inc_ref(Table& table, const size_t * slot_list, const size_t * ref_list, size_t sz, virtual_page_state_t access_flags, void ** addr_list){
+
+        size_t claimed_list[TRANSFER_BATCH_PAGE_SZ]; //indices of slot_list in transfer_state
+        size_t physical_page_list[TRANSFER_BATCH_PAGE_SZ];
+        size_t claimed_sz       = 0u;
+        size_t claim_cap        = std::min(TRANSFER_BATCH_PAGE_SZ, std::max(size_t{1}, table.physical_page_list_sz / 4u)); //claimed pages are neither free nor evictable - do not starve the other mappers
+        size_t first_timestamp  = stat_timestamp();
+        bool is_missed          = false;
+        auto flags              = (table.config.eviction_policy == EvictionPolicy::clock_cold_insert ? virtual_page_state_t{0u} : virtual_page_referenced_flag) | access_flags;
+
+        auto link = [&]{
+            if (claimed_sz == 0u){
+                return;
+            }
+
+            is_missed           = true;
+            TransferBatch batch;
+            batch.descriptor_sz = 0u;
+            size_t acquired_sz  = 0u;
+            std::exception_ptr err{};
+
+            for (; acquired_sz < claimed_sz; ++acquired_sz){
+                try{
+                    physical_page_list[acquired_sz] = physical_page_force_acquire_empty(table);
+                } catch (...){
+                    err = std::current_exception();
+                    break;
+                }
+
+                if (victim_tier_try_take(table, slot_list[claimed_list[acquired_sz]], physical_page_list[acquired_sz])){
+                    continue;
+                }
+
+                char * physical_ptr = static_cast<char *>(table.config.translatee_addr) + table_index(table, physical_page_list[acquired_sz]);
+                char * virtual_ptr  = static_cast<char *>(table.config.translator_addr) + table_index(table, slot_list[claimed_list[acquired_sz]]);
+                transfer_batch_push(batch, table.config.virtual_to_physical_transfer_device, table.config.virtual_to_physical_async_transfer_device, TransferDescriptor{physical_ptr, virtual_ptr, table.config.page_sz});
+                stat_add(table, Stat::fill_transfer);
+                stat_add(table, Stat::fill_byte, table.config.page_sz);
+            }
+
+            transfer_batch_flush(batch, table.config.virtual_to_physical_transfer_device, table.config.virtual_to_physical_async_transfer_device);
+
+            for (size_t i = 0; i < claimed_sz; ++i){
+                size_t page_idx = slot_list[claimed_list[i]];
+
+                if (i >= acquired_sz){
+                    virtual_page_release_transfer(table, page_idx, virtual_page_null_state); //release atomic_flag - nothing is transferred
+                    continue;
+                }
+
+                dg_atomic_exchange(table.physical_page_list[physical_page_list[i]].virtual_page_idx, page_idx, std::memory_order_relaxed); //hint is published by the release below
+                virtual_page_release_transfer(table, page_idx, virtual_page_make(physical_page_list[i], ref_list[claimed_list[i]], flags)); //release atomic_flag + link
+                addr_list[claimed_list[i]] = table.physical_page_list[physical_page_list[i]].addr;
+                stat_add(table, Stat::map_miss);
+            }
+
+            claimed_sz = 0u;
+
+            if (err){
+                std::rethrow_exception(err);
+            }
+        };
+
+        std::fill(addr_list, addr_list + sz, nullptr);
+
+        try{
+            for (size_t i = 0; i < sz; ++i){
+                if (ref_list[i] > VIRTUAL_PAGE_MAX_REF){
+                    throw reference_overflow();
+                }
+
+                addr_list[i] = virtual_page_try_map_n_inc_ref_if_exists(table, slot_list[i], access_flags, ref_list[i]);
+            }
+
+            for (size_t i = 0; i < sz; ++i){
+                if (addr_list[i] != nullptr){
+                    continue;
+                }
+
+                //claim before transfer - same as virtual_page_try_link_n_inc_ref
+                if (!dg_compare_exchange_strong(virtual_page_state(table, slot_list[i]), virtual_page_null_state, virtual_page_loading_state, std::memory_order_acq_rel)){
+                    continue; //linked or in transfer by another thread - mapped one by one below
+                }
+
+                claimed_list[claimed_sz++] = i;
+
+                if (claimed_sz == claim_cap){
+                    link();
+                }
+            }
+
+            link();
+
+            for (size_t i = 0; i < sz; ++i){
+                if (addr_list[i] == nullptr){
+                    addr_list[i] = virtual_page_force_fetch_n_inc_ref(table, slot_list[i], access_flags, ref_list[i]);
+                }
+            }
+        } catch (...){
+            for (size_t i = 0; i < sz; ++i){
+                if (addr_list[i] != nullptr){
+                    virtual_page_dec_ref(table, slot_list[i], ref_list[i]);
+                }
+            }
+
+            throw;
+        }
+
+        if (is_missed){
+            stat_record_miss_latency(table, first_timestamp);
+        }
+    }
+
+    constexpr auto thread_cache_make_tag(size_t page_idx, size_t pin) noexcept -> size_t{
+
+        return ((page_idx + 1) << THREAD_CACHE_PIN_BITCOUNT) | pin;
+    }
+
+    constexpr auto thread_cache_extract_idx(size_t tag) noexcept -> size_t{
+
+        return (tag >> THREAD_CACHE_PIN_BITCOUNT) - 1;
+    }
+
+    constexpr auto thread_cache_extract_pin(size_t tag) noexcept -> size_t{
+
+        return tag & low<size_t>(std::integral_constant<size_t, THREAD_CACHE_PIN_BITCOUNT>{});
+    }
+
+    //try revoke an idle entry - true if the entry was idle + revoked (its shared reference is dropped), false otherwise
+    inline auto thread_cache_entry_try_revoke(Table& table, ThreadCacheEntry& entry, size_t tag) noexcept -> bool{
+
+        if (tag == 0u || thread_cache_extract_pin(tag) != 0u){
+            return false;
+        }
+
+        if (dg_compare_exchange_strong(entry.tag, tag, size_t{0u}, std::memory_order_acq_rel)){
+            virtual_page_dec_ref(table, thread_cache_extract_idx(tag));
+            dg_atomic_fetch_add(table.eviction_epoch, size_t{1}, std::memory_order_relaxed); //progress for physical_page_force_acquire_empty
+            return true;
+        }
+
+        return false;
+    }
+
+    //revoke the idle cached references of page_idx in every thread (not memory-deduced-qualified). pinned entries are left as is - the page is in use
+    inline void thread_cache_revoke(Table& table, size_t page_idx) noexcept{
+
+        if (!table.config.thread_cache_enabled){
+            return;
+        }
+
+        std::lock_guard<std::mutex> lck_grd(table.thread_cache_registry->mtx);
+
+        for (ThreadCache * cache: table.thread_cache_registry->cache_list){
+            ThreadCacheEntry& entry = cache->entry_list[page_idx & (THREAD_CACHE_SZ - 1)];
+            size_t tag              = dg_atomic_load(entry.tag, std::memory_order_relaxed);
+
+            if (tag != 0u && thread_cache_extract_idx(tag) == page_idx){
+                thread_cache_entry_try_revoke(table, entry, tag);
+            }
+        }
+    }
+
+    //revoke every idle cached reference in every thread (not memory-deduced-qualified)
+    inline void thread_cache_revoke_all(Table& table) noexcept{
+
+        if (!table.config.thread_cache_enabled){
+            return;
+        }
+
+        std::lock_guard<std::mutex> lck_grd(table.thread_cache_registry->mtx);
+
+        for (ThreadCache * cache: table.thread_cache_registry->cache_list){
+            for (ThreadCacheEntry& entry: cache->entry_list){
+                thread_cache_entry_try_revoke(table, entry, dg_atomic_load(entry.tag, std::memory_order_relaxed));
+            }
+        }
+    }
+
+    inline auto thread_cache_register(Table& table) -> std::unique_ptr<ThreadCache>{
+
+        auto cache = std::make_unique<ThreadCache>();
+
+        for (ThreadCacheEntry& entry: cache->entry_list){
+            dg_atomic_exchange(entry.tag, size_t{0u}, std::memory_order_relaxed);
+            entry.addr      = nullptr;
+            entry.is_dirty  = false;
+        }
+
+        cache->registry = table.thread_cache_registry;
+        std::lock_guard<std::mutex> lck_grd(cache->registry->mtx);
+        cache->registry->cache_list.push_back(cache.get());
+
+        return cache;
+    }
+
+    //drops every cached reference if the table is still alive - pinned entries at thread exit are a user error (map without unmap), their references are dropped regardless
+    inline void thread_cache_unregister(ThreadCache& cache) noexcept{
+
+        ThreadCacheRegistry& registry = *cache.registry;
+        std::lock_guard<std::mutex> lck_grd(registry.mtx);
+
+        if (!registry.table){
+            return;
+        }
+
+        registry.cache_list.erase(std::find(registry.cache_list.begin(), registry.cache_list.end(), &cache));
+
+        for (ThreadCacheEntry& entry: cache.entry_list){
+            size_t tag = dg_atomic_exchange(entry.tag, size_t{0u}, std::memory_order_acq_rel);
+
+            if (tag != 0u){
+                virtual_page_dec_ref(*registry.table, thread_cache_extract_idx(tag));
+            }
+        }
+    }
+
+    //detach every registered cache from the table (not memory-deduced-qualified) - cached references are gone with the table, caches are freed by their threads
+    inline void thread_cache_detach_all(Table& table) noexcept{
+
+        std::lock_guard<std::mutex> lck_grd(table.thread_cache_registry->mtx);
+        table.thread_cache_registry->cache_list.clear();
+        table.thread_cache_registry->table = nullptr;
+    }
+
+    //the calling thread's caches, one per table it has mapped through
+    struct ThreadCacheHandle{
+        std::vector<std::unique_ptr<ThreadCache>> cache_list;
+
+        ~ThreadCacheHandle() noexcept{
+
+            for (auto& cache: cache_list){
+                thread_cache_unregister(*cache);
+            }
+        }
+    };
+
+    inline auto thread_cache_get(Table& table) -> ThreadCache *{
+
+        thread_local ThreadCacheHandle handle{};
+
+        for (auto& cache: handle.cache_list){
+            if (cache->registry == table.thread_cache_registry){
+                return cache.get();
+            }
+        }
+
+        auto is_detached = [](const std::unique_ptr<ThreadCache>& cache){
+            std::lock_guard<std::mutex> lck_grd(cache->registry->mtx);
+            return cache->registry->table == nullptr;
+        };
+
+        handle.cache_list.erase(std::remove_if(handle.cache_list.begin(), handle.cache_list.end(), is_detached), handle.cache_list.end());
+        handle.cache_list.push_back(thread_cache_register(table));
+
+        return handle.cache_list.back().get();
+    }
+
+    //the entry holds a reference - a writable hit on a clean entry marks the page dirty once
+    inline void thread_cache_entry_mark_access(Table& table, ThreadCacheEntry& entry, size_t page_idx, virtual_page_state_t access_flags) noexcept{
+
+        if (access_flags != 0u && !entry.is_dirty){
+            virtual_page_mark_dirty(table, page_idx);
+            entry.is_dirty = true;
+        }
+    }
+
+    //force map through the calling thread's cache. a hit on a pinned entry is a thread-local load + store, a hit on an idle entry is an uncontended cmpexch on a thread-local line
+    //a busy entry (pinned by another page) or a saturated pin falls back to virtual_page_force_fetch_n_inc_ref. same guarantees as virtual_page_force_fetch_n_inc_ref
+    inline auto thread_cache_fetch_n_inc_ref(Table& table, size_t page_idx, virtual_page_state_t access_flags) -> void *{
+
+        ThreadCacheEntry& entry = thread_cache_get(table)->entry_list[page_idx & (THREAD_CACHE_SZ - 1)];
+        size_t tag              = dg_atomic_load(entry.tag, std::memory_order_acquire);
+
+        if (tag != 0u && thread_cache_extract_idx(tag) == page_idx){
+            size_t pin = thread_cache_extract_pin(tag);
+
+            if (pin == low<size_t>(std::integral_constant<size_t, THREAD_CACHE_PIN_BITCOUNT>{})){
+                return virtual_page_force_fetch_n_inc_ref(table, page_idx, access_flags);
+            }
+
+            if (pin != 0u){
+                dg_atomic_exchange(entry.tag, tag + 1, std::memory_order_relaxed);
+                thread_cache_entry_mark_access(table, entry, page_idx, access_flags);
+                stat_add(table, Stat::thread_cache_hit);
+                return entry.addr;
+            }
+
+            if (dg_compare_exchange_strong(entry.tag, tag, tag + 1, std::memory_order_acq_rel)){ //races against revocation
+                thread_cache_entry_mark_access(table, entry, page_idx, access_flags);
+                stat_add(table, Stat::thread_cache_hit);
+                return entry.addr;
+            }
+
+            tag = dg_atomic_load(entry.tag, std::memory_order_acquire); //revoked
+        }
+
+        if (tag != 0u){
+            if (thread_cache_extract_pin(tag) != 0u){
+                return virtual_page_force_fetch_n_inc_ref(table, page_idx, access_flags);
+            }
+
+            thread_cache_entry_try_revoke(table, entry, tag); //evict the idle entry - a failed cmpexch means it was revoked by another thread, entry is empty either way
+        }
+
+        if (dg_atomic_load(table.thread_cache_pressure, std::memory_order_relaxed)){
+            return virtual_page_force_fetch_n_inc_ref(table, page_idx, access_flags);
+        }
+
+        void * rs       = virtual_page_force_fetch_n_inc_ref(table, page_idx, access_flags);
+        entry.addr      = rs;
+        entry.is_dirty  = access_flags != 0u;
+        dg_atomic_exchange(entry.tag, thread_cache_make_tag(page_idx, 1u), std::memory_order_release); //only the owning thread fills an empty entry
+
+        return rs;
+    }
+
+    //decrease the reference taken by thread_cache_fetch_n_inc_ref on the same thread (not memory-deduced-qualified (void)) 
+    inline void thread_cache_dec_ref(Table& table, size_t page_idx) noexcept{
+
+        ThreadCacheEntry& entry = thread_cache_get(table)->entry_list[page_idx & (THREAD_CACHE_SZ - 1)];
+        size_t tag              = dg_atomic_load(entry.tag, std::memory_order_relaxed);
+
+        if (tag != 0u && thread_cache_extract_idx(tag) == page_idx && thread_cache_extract_pin(tag) != 0u){
+            dg_atomic_exchange(entry.tag, tag - 1, std::memory_order_release); //1 -> 0 makes the entry revocable
+
+            if (thread_cache_extract_pin(tag) == 1u && dg_atomic_load(table.thread_cache_pressure, std::memory_order_relaxed)){ //do not retain idle entries under pressure
+                thread_cache_entry_try_revoke(table, entry, tag - 1);
+            }
+
+            return;
+        }
+
+        virtual_page_dec_ref(table, page_idx);
+    }
+
+    //wait + drop the page_idx virtual page. the exit of this function guarantees the up-to-date as of at least __function_invoked_time__ (memory-deduced-qualified (void))
+    inline void virtual_page_drop(Table& table, size_t page_idx) noexcept{
+
+        size_t round = 0u;
+
+        while (!virtual_page_try_release_if_zero_ref(table, page_idx)){ //waits for users to unmap - references are not announced, so backoff instead of parking
+            thread_cache_revoke(table, page_idx);
+            backoff(round);
+        } 
+    }
+
+    //wait + sync the page_idx virtual_page. the exit of this function guarantees the up-to-date as of at least __function_invoked_time__ (memory-deduced-qualified (void))
+    inline void virtual_page_sync(Table& table, size_t page_idx) noexcept{
+
+        size_t round = 0u;
+
+        while (!virtual_page_try_sync(table, page_idx)){ //waits for users to unmap - references are not announced, so backoff instead of parking
+            thread_cache_revoke(table, page_idx);
+            backoff(round);
+        }
+    }
+
+    //wait + drop (is_unlink) or sync the pages of [first, last). the exit of this function guarantees the up-to-date as of at least __function_invoked_time__ (memory-deduced-qualified (void))
+    inline void virtual_page_write_back_range(Table& table, bool is_unlink, size_t first, size_t last) noexcept{
+
+        virtual_page_batch_write_back(table, is_unlink, first, last); //batched first pass, the stragglers (referenced or in transfer) are waited one by one
+
+        for (size_t i = virtual_page_next_linked(table, first, last); i < last; i = virtual_page_next_linked(table, i + 1, last)){ //pages linked after the invocation may be skipped
+            if (is_unlink){
+                virtual_page_drop(table, i);
+            } else{
+                virtual_page_sync(table, i);
+            }
+        }
+    }
+
+    //wait + drop all pages. the exit of this function guarantees the up-to-date as of at least __function_invoked_time__ (memory-deduced-qualified (void))
+    inline void virtual_page_drop_all(Table& table) noexcept{
+
+        virtual_page_write_back_range(table, true, 0u, table.virtual_page_list_sz);
+    }
+
+    //wait + sync all pages. the exit of this function guarantees the up-to-date as of at least __function_invoked_time__ ...
+    inline void virtual_page_sync_all(Table& table) noexcept{
+
+        virtual_page_write_back_range(table, false, 0u, table.virtual_page_list_sz);
+    }
+
+    //shared by the workers of a parallel drop_all/sync_all - lives on the stack of the waiting caller
+    struct WriteBackTask{
+        Table * table;
+        bool is_unlink;
+        dg_atomic_type<size_t> cursor; //first slot of the next unclaimed partition
+        dg_atomic_type<size_t> inflight; //posted workers that have not retired
+    };
+
+    //pull partitions until the table is exhausted - null pages cost one load each
+    inline void write_back_task_drain(WriteBackTask& task) noexcept{
+
+        Table& table = *task.table;
+
+        while (true){
+            size_t first = dg_atomic_fetch_add(task.cursor, WRITE_BACK_PARTITION_SZ, std::memory_order_relaxed);
+
+            if (first >= table.virtual_page_list_sz){
+                return;
+            }
+
+            virtual_page_write_back_range(table, task.is_unlink, first, std::min(first + WRITE_BACK_PARTITION_SZ, table.virtual_page_list_sz));
+        }
+    }
+
+    inline void write_back_task_run(void * arg) noexcept{
+
+        auto * task = static_cast<WriteBackTask *>(arg);
+        write_back_task_drain(*task);
+        dg_atomic_fetch_sub(task->inflight, size_t{1}, std::memory_order_release);
+    }
+
+    //drop_all (is_unlink) or sync_all on at most max_concurrency threads - the calling thread + up to max_concurrency - 1 workers posted to executor. partitions are pulled from a shared cursor, so a slow partition does not stall the others
+    //max_concurrency caps the write backs in flight (the transfer bandwidth taken from live traffic). same guarantees as virtual_page_drop_all/virtual_page_sync_all (memory-deduced-qualified (void))
+    inline void virtual_page_parallel_write_back(Table& table, bool is_unlink, Executor executor, size_t max_concurrency) noexcept{
+
+        WriteBackTask task{};
+        task.table      = &table;
+        task.is_unlink  = is_unlink;
+        dg_atomic_exchange(task.cursor, size_t{0u}, std::memory_order_relaxed);
+        dg_atomic_exchange(task.inflight, size_t{0u}, std::memory_order_relaxed);
+
+        size_t partition_count  = table.virtual_page_list_sz / WRITE_BACK_PARTITION_SZ + size_t{table.virtual_page_list_sz % WRITE_BACK_PARTITION_SZ != 0u};
+        size_t worker_count     = executor.post == nullptr ? size_t{0u} : std::min(std::max(max_concurrency, size_t{1}) - 1, partition_count - 1);
+
+        for (size_t i = 0; i < worker_count; ++i){
+            dg_atomic_fetch_add(task.inflight, size_t{1}, std::memory_order_relaxed);
+
+            if (!executor.post(executor.ctx, &write_back_task_run, &task)){
+                dg_atomic_fetch_sub(task.inflight, size_t{1}, std::memory_order_relaxed); //the caller drains the rest
+                break;
+            }
+        }
+
+        write_back_task_drain(task);
+
+        size_t round = 0u;
+
+        while (dg_atomic_load(task.inflight, std::memory_order_acquire) != 0u){
+            backoff(round);
+        }
+    }
+
+    //drop a reference taken by a map - through the calling thread's cache if enabled, the calling thread must be the mapping thread then (not memory-deduced-qualified (void))
+    inline void virtual_page_unmap(Table& table, size_t page_idx) noexcept{
+
+        if (table.config.thread_cache_enabled){
+            thread_cache_dec_ref(table, page_idx);
+        } else{
+            virtual_page_dec_ref(table, page_idx);
+        }
+    }
+    
+    //--user-interface--
+
+    //reference Executor - a fixed pool of workers draining a FIFO task queue. queued tasks are drained before destruction
+    class ThreadPoolExecutor{
+
+        private:
+
+            struct Task{
+                executor_task_t task;
+                void * arg;
+            };
+
+            std::mutex mtx;
+            std::condition_variable task_cv;
+            std::deque<Task> task_queue;
+            bool is_stopped;
+            std::vector<std::thread> worker_list;
+
+            void work() noexcept{
+
+                while (true){
+                    std::unique_lock<std::mutex> lck(this->mtx);
+                    this->task_cv.wait(lck, [&]{return !this->task_queue.empty() || this->is_stopped;});
+
+                    if (this->task_queue.empty()){
+                        return;
+                    }
+
+                    Task task = this->task_queue.front();
+                    this->task_queue.pop_front();
+                    lck.unlock();
+
+                    task.task(task.arg);
+                }
+            }
+
+            static auto post(void * ctx, executor_task_t task, void * arg) noexcept -> bool{
+
+                auto * self = static_cast<ThreadPoolExecutor *>(ctx);
+
+                try{
+                    std::lock_guard<std::mutex> lck(self->mtx);
+                    self->task_queue.push_back(Task{task, arg});
+                } catch (...){ //out of memory
+                    return false;
+                }
+
+                self->task_cv.notify_one();
+                return true;
+            }
+
+        public:
+
+            explicit ThreadPoolExecutor(size_t thread_count): mtx(),
+                                                              task_cv(),
+                                                              task_queue(),
+                                                              is_stopped(false),
+                                                              worker_list(){
+
+                if (thread_count == 0u){
+                    std::abort();
+                }
+
+                for (size_t i = 0; i < thread_count; ++i){
+                    this->worker_list.emplace_back([this]{this->work();});
+                }
+            }
+
+            ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+            ThreadPoolExecutor& operator =(const ThreadPoolExecutor&) = delete;
+
+            ~ThreadPoolExecutor() noexcept{
+
+                {
+                    std::lock_guard<std::mutex> lck(this->mtx);
+                    this->is_stopped = true;
+                }
+
+                this->task_cv.notify_all();
+
+                for (auto& worker: this->worker_list){
+                    worker.join();
+                }
+            }
+
+            auto get() noexcept -> Executor{
+
+                return Executor{this, &ThreadPoolExecutor::post};
+            }
+    };
+
+    //reference AsyncTransferDevice - descriptors are split into jobs of at most THREAD_POOL_TRANSFER_SPLIT_SZ and copied by a ThreadPoolExecutor through a synchronous mem_transfer_device_t
+    //submit does not wait for the copies, so the write backs of a batch (and the chunks of a page) overlap. must outlive every TLB it is plugged into
+    class ThreadPoolTransferDevice{
+
+        private:
+
+            struct Job{
+                TransferDescriptor descriptor;
+                transfer_token_t token;
+            };
+
+            mem_transfer_device_t device;
+            std::mutex mtx;
+            std::condition_variable done_cv;
+            std::deque<Job> job_queue; //one executor task is posted per job - a task runs the front job
+            std::unordered_map<transfer_token_t, size_t> pending_map; //token -> remaining job count, erased once every job is done
+            transfer_token_t token_counter;
+            ThreadPoolExecutor executor; //last - drained + joined before the queues are destroyed
+
+            static void run_job(void * ctx) noexcept{
+
+                auto * self = static_cast<ThreadPoolTransferDevice *>(ctx);
+                std::unique_lock<std::mutex> lck(self->mtx);
+                Job job = self->job_queue.front();
+                self->job_queue.pop_front();
+                lck.unlock();
+
+                self->device(job.descriptor.dst, job.descriptor.src, job.descriptor.sz);
+
+                lck.lock();
+                auto map_ptr = self->pending_map.find(job.token);
+
+                if (--map_ptr->second == 0u){
+                    self->pending_map.erase(map_ptr);
+                    self->done_cv.notify_all();
+                }
+            }
+
+            static auto submit(void * ctx, const TransferDescriptor * descriptor_list, size_t descriptor_sz) noexcept -> transfer_token_t{
+
+                auto * self = static_cast<ThreadPoolTransferDevice *>(ctx);
+                std::unique_lock<std::mutex> lck(self->mtx);
+                transfer_token_t token  = self->token_counter++; 
+                size_t job_sz           = 0u;
+
+                try{
+                    for (size_t i = 0; i < descriptor_sz; ++i){
+                        for (size_t offs = 0; offs < descriptor_list[i].sz; offs += THREAD_POOL_TRANSFER_SPLIT_SZ){
+                            TransferDescriptor job_descriptor{static_cast<char *>(descriptor_list[i].dst) + offs, static_cast<const char *>(descriptor_list[i].src) + offs, std::min(THREAD_POOL_TRANSFER_SPLIT_SZ, descriptor_list[i].sz - offs)};
+                            self->job_queue.push_back(Job{job_descriptor, token});
+                            job_sz += 1;
+                        }
+                    }
+
+                    if (job_sz != 0u){
+                        self->pending_map.emplace(token, job_sz);
+                    }
+                } catch (...){ //out of memory - roll back + transfer on the calling thread
+                    self->job_queue.erase(std::prev(self->job_queue.end(), job_sz), self->job_queue.end());
+                    lck.unlock();
+
+                    for (size_t i = 0; i < descriptor_sz; ++i){
+                        self->device(descriptor_list[i].dst, descriptor_list[i].src, descriptor_list[i].sz);
+                    }
+
+                    return token; //not in pending_map - completed
+                }
+
+                lck.unlock();
+                Executor executor = self->executor.get();
+
+                for (size_t i = 0; i < job_sz; ++i){
+                    if (!executor.post(executor.ctx, &ThreadPoolTransferDevice::run_job, self)){
+                        run_job(self); //out of memory - the calling thread takes the job
+                    }
+                }
+
+                return token;
+            }
+
+            static void wait(void * ctx, transfer_token_t token) noexcept{
+
+                auto * self = static_cast<ThreadPoolTransferDevice *>(ctx);
+                std::unique_lock<std::mutex> lck(self->mtx);
+                self->done_cv.wait(lck, [&]{return self->pending_map.find(token) == self->pending_map.end();});
+            }
+
+        public:
+
+            ThreadPoolTransferDevice(mem_transfer_device_t device, size_t thread_count): device(device),
+                                                                                         mtx(),
+                                                                                         done_cv(),
+                                                                                         job_queue(),
+                                                                                         pending_map(),
+                                                                                         token_counter(0u),
+                                                                                         executor(thread_count){
+
+                if (device == nullptr){
+                    std::abort();
+                }
+            }
+
+            ThreadPoolTransferDevice(const ThreadPoolTransferDevice&) = delete;
+            ThreadPoolTransferDevice& operator =(const ThreadPoolTransferDevice&) = delete;
+
+            auto get() noexcept -> AsyncTransferDevice{
+
+                return AsyncTransferDevice{this, &ThreadPoolTransferDevice::submit, &ThreadPoolTransferDevice::wait};
+            }
+    };
+
+    //a pinned virtual page - move-only, unmapped on destruction (or reset). with thread caches enabled, it must be destroyed by the mapping thread
+    class PageRef{
+
+        private:
+
+            Table * table;
+            size_t page_slot;
+            void * addr;
+
+        public:
+
+            PageRef() noexcept: table(nullptr),
+                                page_slot(0u),
+                                addr(nullptr){}
+
+            PageRef(Table * table, size_t page_slot, void * addr) noexcept: table(table),
+                                                                            page_slot(page_slot),
+                                                                            addr(addr){}
+
+            PageRef(const PageRef&) = delete;
+            PageRef& operator =(const PageRef&) = delete;
+
+            PageRef(PageRef&& other) noexcept: table(std::exchange(other.table, nullptr)),
+                                               page_slot(other.page_slot),
+                                               addr(std::exchange(other.addr, nullptr)){}
+
+            PageRef& operator =(PageRef&& other) noexcept{
+
+                if (this != &other){
+                    this->reset();
+                    this->table     = std::exchange(other.table, nullptr);
+                    this->page_slot = other.page_slot;
+                    this->addr      = std::exchange(other.addr, nullptr);
+                }
+
+                return *this;
+            }
+
+            ~PageRef() noexcept{
+
+                this->reset();
+            }
+
+            //the mapped addr of the pinned ptr, null if empty
+            auto get() const noexcept -> void *{
+
+                return this->addr;
+            }
+
+            explicit operator bool() const noexcept{
+
+                return this->table != nullptr;
+            }
+
+            void reset() noexcept{
+
+                if (!this->table){
+                    return;
+                }
+
+                trace_record(*this->table, TraceOp::unmap, table_index(*this->table, this->page_slot));
+                virtual_page_unmap(*this->table, this->page_slot);
+                this->table = nullptr;
+                this->addr  = nullptr;
+            }
+    };
+
+    struct MappedSpan{
+        void * addr;
+        size_t sz;
+    };
+
+    //the pinned virtual pages of a mapped range - move-only, every page is unmapped on destruction (or reset). with thread caches enabled, it must be destroyed by the mapping thread
+    //span_list is the scatter list of the range in translator order - physically adjacent pages are coalesced into one span
+    class MappedRange{
+
+        private:
+
+            Table * table;
+            size_t first_slot;
+            size_t slot_count;
+            std::vector<MappedSpan> span_list;
+
+        public:
+
+            MappedRange() noexcept: table(nullptr),
+                                    first_slot(0u),
+                                    slot_count(0u),
+                                    span_list(){}
+
+            MappedRange(Table * table, size_t first_slot, size_t slot_count, std::vector<MappedSpan> span_list) noexcept: table(table),
+                                                                                                                          first_slot(first_slot),
+                                                                                                                          slot_count(slot_count),
+                                                                                                                          span_list(std::move(span_list)){}
+
+            MappedRange(const MappedRange&) = delete;
+            MappedRange& operator =(const MappedRange&) = delete;
+
+            MappedRange(MappedRange&& other) noexcept: table(std::exchange(other.table, nullptr)),
+                                                       first_slot(other.first_slot),
+                                                       slot_count(std::exchange(other.slot_count, size_t{0u})),
+                                                       span_list(std::move(other.span_list)){}
+
+            MappedRange& operator =(MappedRange&& other) noexcept{
+
+                if (this != &other){
+                    this->reset();
+                    this->table         = std::exchange(other.table, nullptr);
+                    this->first_slot    = other.first_slot;
+                    this->slot_count    = std::exchange(other.slot_count, size_t{0u});
+                    this->span_list     = std::move(other.span_list);
+                }
+
+                return *this;
+            }
+
+            ~MappedRange() noexcept{
+
+                this->reset();
+            }
+
+            auto spans() const noexcept -> const std::vector<MappedSpan>&{
+
+                return this->span_list;
+            }
+
+            //the mapped addr of the range if the pinned pages are physically adjacent, null otherwise
+            auto contiguous() const noexcept -> void *{
+
+                return this->span_list.size() == 1u ? this->span_list.front().addr : nullptr;
+            }
+
+            explicit operator bool() const noexcept{
+
+                return this->table != nullptr;
+            }
+
+            void reset() noexcept{
+
+                if (!this->table){
+                    return;
+                }
+
+                for (size_t i = 0; i < this->slot_count; ++i){
+                    trace_record(*this->table, TraceOp::unmap, table_index(*this->table, this->first_slot + i));
+                    virtual_page_unmap(*this->table, this->first_slot + i);
+                }
+
+                this->table         = nullptr;
+                this->slot_count    = 0u;
+                this->span_list.clear();
+            }
+    };
+
+    #if defined(__cpp_lib_coroutine)
+
+    inline void coroutine_resume_task(void * arg) noexcept{
+
+        std::coroutine_handle<>::from_address(arg).resume();
+    }
+
+    //resume handle through executor - on the calling thread if empty or if the post is refused
+    inline void coroutine_resume(Executor executor, std::coroutine_handle<> handle) noexcept{
+
+        if (executor.post != nullptr && executor.post(executor.ctx, &coroutine_resume_task, handle.address())){
+            return;
+        }
+
+        handle.resume();
+    }
+
+    //co_await of TLB::co_map - lives in the coroutine frame, so it outlives the posted fill. the fill task must not touch the awaitable after the resume
+    class MapAwaitable{
+
+        private:
+
+            Table * table;
+            size_t page_slot;
+            size_t page_offs;
+            virtual_page_state_t access_flags;
+            Executor fill_executor;
+            Executor resume_executor;
+            std::coroutine_handle<> handle;
+            void * addr;
+            std::exception_ptr err;
+
+            void fetch() noexcept{
+
+                try{
+                    this->addr = virtual_page_force_fetch_n_inc_ref(*this->table, this->page_slot, this->access_flags); //never through a thread cache - the coroutine may resume on another thread
+                } catch (...){
+                    this->err = std::current_exception();
+                }
+            }
+
+            //one attempt on fill_executor - false if addr (or err) is set. an in-flight transfer registers a TransferWaiter instead of holding a thread, a miss is filled inline (is_fill_inline) or posted
+            //true if the coroutine stays suspended - this may be resumed already, it is not touched anymore
+            auto step(bool is_fill_inline) noexcept -> bool{
+
+                while (true){
+                    try{
+                        this->addr = virtual_page_try_map_n_inc_ref_if_linked(*this->table, this->page_slot, this->access_flags);
+                    } catch (...){
+                        this->err = std::current_exception();
+                        return false;
+                    }
+
+                    if (this->addr != nullptr){
+                        return false;
+                    }
+
+                    auto state = virtual_page_load_state(*this->table, this->page_slot, std::memory_order_acquire);
+
+                    if (state == virtual_page_null_state){
+                        break;
+                    }
+
+                    if (!virtual_page_is_transfer(state)){
+                        continue;
+                    }
+
+                    try{
+                        if (virtual_page_add_transfer_waiter(*this->table, this->page_slot, state, TransferWaiter{this->fill_executor, &MapAwaitable::retry_task, this})){
+                            return true;
+                        }
+                    } catch (...){ //out of memory - waited as a miss
+                        break;
+                    }
+                }
+
+                if (!is_fill_inline && this->fill_executor.post(this->fill_executor.ctx, &MapAwaitable::fetch_task, this)){
+                    return true;
+                }
+
+                this->fetch();
+                return false;
+            }
+
+            //the waiters deferred by the publish of the fill are drained before the resume - the table is not touched after it
+            static void fetch_task(void * arg) noexcept{
+
+                auto * self = static_cast<MapAwaitable *>(arg);
+                self->fetch();
+                virtual_page_drain_deferred_waiter(*self->table);
+                coroutine_resume(self->resume_executor, self->handle);
+            }
+
+            static void retry_task(void * arg) noexcept{
+
+                auto * self = static_cast<MapAwaitable *>(arg);
+
+                if (!self->step(true)){
+                    virtual_page_drain_deferred_waiter(*self->table);
+                    coroutine_resume(self->resume_executor, self->handle);
+                }
+            }
+
+        public:
+
+            MapAwaitable(Table * table, size_t page_slot, size_t page_offs, virtual_page_state_t access_flags, Executor fill_executor, Executor resume_executor) noexcept: table(table),
+                                                                                                                                                                          page_slot(page_slot),
+                                                                                                                                                                          page_offs(page_offs),
+                                                                                                                                                                          access_flags(access_flags),
+                                                                                                                                                                          fill_executor(fill_executor),
+                                                                                                                                                                          resume_executor(resume_executor),
+                                                                                                                                                                          handle(),
+                                                                                                                                                                          addr(nullptr),
+                                                                                                                                                                          err(){}
+
+            //a linked page (or null ptr) completes without suspension
+            auto await_ready() -> bool{
+
+                if (this->table == nullptr){
+                    return true;
+                }
+
+                this->addr = virtual_page_try_map_n_inc_ref_if_linked(*this->table, this->page_slot, this->access_flags);
+                return this->addr != nullptr;
+            }
+
+            //a miss is filled on fill_executor, an in-flight transfer is waited on the page's waiter list - both inline (no suspension) if fill_executor is empty or the post is refused
+            auto await_suspend(std::coroutine_handle<> handle) noexcept -> bool{
+
+                this->handle = handle;
+
+                if (this->fill_executor.post == nullptr){
+                    this->fetch();
+                    virtual_page_drain_deferred_waiter(*this->table);
+                    return false;
+                }
+
+                if (this->step(false)){
+                    return true;
+                }
+
+                virtual_page_drain_deferred_waiter(*this->table);
+                return false;
+            }
+
+            //the mapped addr, null for null ptr. rethrows no_page_found + reference_overflow of the fill
+            auto await_resume() -> void *{
+
+                if (this->err){
+                    std::rethrow_exception(this->err);
+                }
+
+                if (this->table == nullptr){
+                    return nullptr;
+                }
+
+                if (this->access_flags != 0u){
+                    size_t physical_page_idx = table_slot(*this->table, std::distance(static_cast<const char *>(this->table->config.translatee_addr), static_cast<const char *>(this->addr)));
+                    physical_page_mark_dirty_chunk(*this->table, physical_page_idx, 0u, this->table->config.page_sz); //same as map()
+                }
+
+                trace_record(*this->table, this->access_flags != 0u ? TraceOp::map : TraceOp::map_readonly, table_index(*this->table, this->page_slot) + this->page_offs, this->access_flags != 0u ? this->table->config.page_sz : size_t{0u});
+                return static_cast<char *>(this->addr) + this->page_offs;
+            }
+    };
+
+    //co_await of TLB::co_sync - same lifetime rules as MapAwaitable
+    class SyncAwaitable{
+
+        private:
+
+            Table * table;
+            size_t page_slot;
+            Executor sync_executor;
+            Executor resume_executor;
+            std::coroutine_handle<> handle;
+
+            //one attempt on sync_executor - same contract as MapAwaitable::step. a referenced page is waited (backoff) inline (is_sync_inline) or posted
+            auto step(bool is_sync_inline) noexcept -> bool{
+
+                while (!virtual_page_try_sync(*this->table, this->page_slot)){
+                    auto state = virtual_page_load_state(*this->table, this->page_slot, std::memory_order_acquire);
+
+                    if (!virtual_page_is_transfer(state)){
+                        if (!is_sync_inline && this->sync_executor.post(this->sync_executor.ctx, &SyncAwaitable::sync_task, this)){
+                            return true;
+                        }
+
+                        virtual_page_sync(*this->table, this->page_slot);
+                        return false;
+                    }
+
+                    try{
+                        if (virtual_page_add_transfer_waiter(*this->table, this->page_slot, state, TransferWaiter{this->sync_executor, &SyncAwaitable::retry_task, this})){
+                            return true;
+                        }
+                    } catch (...){ //out of memory - waited inline
+                        virtual_page_sync(*this->table, this->page_slot);
+                        return false;
+                    }
+                }
+
+                return false;
+            }
+
+            static void sync_task(void * arg) noexcept{
+
+                auto * self = static_cast<SyncAwaitable *>(arg);
+                virtual_page_sync(*self->table, self->page_slot);
+                virtual_page_drain_deferred_waiter(*self->table);
+                coroutine_resume(self->resume_executor, self->handle);
+            }
+
+            static void retry_task(void * arg) noexcept{
+
+                auto * self = static_cast<SyncAwaitable *>(arg);
+
+                if (!self->step(true)){
+                    virtual_page_drain_deferred_waiter(*self->table);
+                    coroutine_resume(self->resume_executor, self->handle);
+                }
+            }
+
+        public:
+
+            SyncAwaitable(Table * table, size_t page_slot, Executor sync_executor, Executor resume_executor) noexcept: table(table),
+                                                                                                                        page_slot(page_slot),
+                                                                                                                        sync_executor(sync_executor),
+                                                                                                                        resume_executor(resume_executor),
+                                                                                                                        handle(){}
+
+            //an unlinked, clean or zero-ref page is synchronized without suspension
+            auto await_ready() noexcept -> bool{
+
+                return this->table == nullptr || virtual_page_try_sync(*this->table, this->page_slot);
+            }
+
+            //a referenced page is waited on sync_executor, an in-transfer page on the page's waiter list - inline if sync_executor is empty or the post is refused
+            auto await_suspend(std::coroutine_handle<> handle) noexcept -> bool{
+
+                this->handle = handle;
+
+                if (this->sync_executor.post == nullptr){
+                    virtual_page_sync(*this->table, this->page_slot);
+                    virtual_page_drain_deferred_waiter(*this->table);
+                    return false;
+                }
+
+                if (this->step(false)){
+                    return true;
+                }
+
+                virtual_page_drain_deferred_waiter(*this->table);
+                return false;
+            }
+
+            void await_resume() noexcept{}
+    };
+
+    #endif
+
+    //an independent translator/translatee pair - page tables, page pool, eviction and thread caches are per instance
+    //every mapping must be unmapped before destruction - the destructor flushes (write back + unlink) every page, then frees the tables
+    class TLB{
+
+        private:
+
+            std::unique_ptr<Table> table;
+
+            //dirty_sz is the byte count written through the mapping, starting at ptr (map_write) - std::nullopt dirties the whole page, whatever the offset of ptr (map). only meaningful for dirty access_flags
+            auto map_with_access(void * ptr, virtual_page_state_t access_flags, std::optional<size_t> dirty_sz) -> void *{
+
+                if (!ptr){
+                    return nullptr;
+                }
+
+                size_t idx              = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr));
+                size_t page_slot        = table_slot(*this->table, idx);
+                size_t page_offs        = table_offset(*this->table, idx);
+                void * translatee_page  = this->table->config.thread_cache_enabled ? thread_cache_fetch_n_inc_ref(*this->table, page_slot, access_flags) : virtual_page_force_fetch_n_inc_ref(*this->table, page_slot, access_flags);  
+
+                if (access_flags != 0u){
+                    size_t physical_page_idx = table_slot(*this->table, std::distance(static_cast<const char *>(this->table->config.translatee_addr), static_cast<const char *>(translatee_page)));
+                    physical_page_mark_dirty_chunk(*this->table, physical_page_idx, dirty_sz ? page_offs : size_t{0u}, dirty_sz.value_or(this->table->config.page_sz));
+                }
+
+                trace_record(*this->table, access_flags != 0u ? TraceOp::map : TraceOp::map_readonly, idx, access_flags != 0u ? dirty_sz.value_or(this->table->config.page_sz) : size_t{0u});
+                return static_cast<char *>(translatee_page) + page_offs;
+            }
+
+            //out[i] is the mapped addr of in[i] (null for null). the inputs are grouped by slot - one cmpexch per distinct page takes the references of the whole group, misses are linked together
+            //a run of the same pointer is one sort entry - repeated gathers of one element cost a compare + store per pointer
+            void map_batch_with_access(const void * const * in, void ** out, size_t n, virtual_page_state_t access_flags){
+
+                std::vector<std::tuple<size_t, size_t, size_t>> slot_list{}; //(slot, in idx, run sz)
+
+                for (size_t i = 0; i < n;){
+                    if (!in[i]){
+                        out[i++] = nullptr;
+                        continue;
+                    }
+
+                    size_t j = i + 1;
+
+                    while (j < n && in[j] == in[i]){
+                        j += 1;
+                    }
+
+                    slot_list.emplace_back(table_slot(*this->table, std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(in[i]))), i, j - i);
+                    i = j;
+                }
+
+                std::sort(slot_list.begin(), slot_list.end());
+
+                std::vector<size_t> page_list{};
+                std::vector<size_t> ref_list{};
+
+                for (size_t i = 0; i < slot_list.size(); ++i){
+                    if (i != 0u && std::get<0>(slot_list[i]) == std::get<0>(slot_list[i - 1])){
+                        ref_list.back() += std::get<2>(slot_list[i]);
+                    } else{
+                        page_list.push_back(std::get<0>(slot_list[i]));
+                        ref_list.push_back(std::get<2>(slot_list[i]));
+                    }
+                }
+
+                std::vector<void *> addr_list(page_list.size());
+                virtual_page_batch_fetch_n_inc_ref(*this->table, page_list.data(), ref_list.data(), page_list.size(), access_flags, addr_list.data());
+
+                for (size_t i = 0, j = 0; i < slot_list.size(); ++i){
+                    if (i != 0u && std::get<0>(slot_list[i]) != std::get<0>(slot_list[i - 1])){
+                        j += 1;
+                    }
+
+                    size_t first            = std::get<1>(slot_list[i]);
+                    size_t page_offs        = table_offset(*this->table, std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(in[first])));
+                    std::fill(out + first, out + first + std::get<2>(slot_list[i]), static_cast<char *>(addr_list[j]) + page_offs);
+                }
+
+                if (access_flags != 0u){
+                    for (void * addr: addr_list){
+                        size_t physical_page_idx = table_slot(*this->table, std::distance(static_cast<const char *>(this->table->config.translatee_addr), static_cast<const char *>(addr)));
+                        physical_page_mark_dirty_chunk(*this->table, physical_page_idx, 0u, this->table->config.page_sz);
+                    }
+                }
+
+                for (const auto& slot_tuple: slot_list){ //one record per pointer - as n map()s
+                    size_t idx = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(in[std::get<1>(slot_tuple)]));
+
+                    for (size_t i = 0; i < std::get<2>(slot_tuple); ++i){
+                        trace_record(*this->table, access_flags != 0u ? TraceOp::map : TraceOp::map_readonly, idx, access_flags != 0u ? this->table->config.page_sz : size_t{0u});
+                    }
+                }
+            }
+
+            //pins the pages in ascending slot order - two concurrent ranges never wait on each other, a range wider than the page pool throws no_page_found
+            //pinned pages are unmapped if a pin throws
+            auto map_range_with_access(void * ptr, size_t sz, virtual_page_state_t access_flags) -> MappedRange{
+
+                if (!ptr || sz == 0u){
+                    return MappedRange();
+                }
+
+                size_t idx          = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr));
+                size_t first_slot   = table_slot(*this->table, idx);
+                size_t last_slot    = table_slot(*this->table, idx + sz - 1) + 1;
+                size_t slot_count   = 0u;
+                std::vector<MappedSpan> span_list{};
+                span_list.reserve(last_slot - first_slot); //push_back does not throw while pages are pinned
+
+                try{
+                    for (size_t slot = first_slot; slot != last_slot; ++slot){
+                        size_t first_offs   = slot == first_slot ? table_offset(*this->table, idx) : size_t{0u};
+                        size_t last_offs    = slot + 1 == last_slot ? table_offset(*this->table, idx + sz - 1) + 1 : this->table->config.page_sz;
+                        char * page_ptr     = static_cast<char *>(this->table->config.translator_addr) + table_index(*this->table, slot) + first_offs;
+                        char * mapped_ptr   = static_cast<char *>(this->map_with_access(page_ptr, access_flags, last_offs - first_offs));
+                        slot_count         += 1;
+
+                        if (!span_list.empty() && static_cast<char *>(span_list.back().addr) + span_list.back().sz == mapped_ptr){
+                            span_list.back().sz += last_offs - first_offs;
+                        } else{
+                            span_list.push_back(MappedSpan{mapped_ptr, last_offs - first_offs});
+                        }
+                    }
+                } catch (...){
+                    for (size_t i = 0; i < slot_count; ++i){
+                        virtual_page_unmap(*this->table, first_slot + i);
+                    }
+
+                    throw;
+                }
+
+                return MappedRange(this->table.get(), first_slot, slot_count, std::move(span_list));
+            }
+
+            #if defined(__cpp_lib_coroutine)
+
+            auto co_map_with_access(void * ptr, virtual_page_state_t access_flags, Executor executor, Executor resume_executor) noexcept -> MapAwaitable{
+
+                if (!ptr){
+                    return MapAwaitable(nullptr, 0u, 0u, access_flags, {}, {});
+                }
+
+                virtual_page_drain_deferred_waiter(*this->table);
+                size_t idx = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr));
+                return MapAwaitable(this->table.get(), table_slot(*this->table, idx), table_offset(*this->table, idx), access_flags, executor.post != nullptr ? executor : this->table->config.prefetch_executor, resume_executor);
+            }
+
+            #endif
+
+        public:
+
+            explicit TLB(const Config& config){
+
+                if (config.page_sz < MIN_PAGE_SZ || (config.page_sz & (config.page_sz - 1)) != 0u){
+                    std::abort();
+                }
+
+                if (config.dirty_chunk_sz != 0u && (config.dirty_chunk_sz > config.page_sz || (config.dirty_chunk_sz & (config.dirty_chunk_sz - 1)) != 0u)){ //pow2 <= page_sz divides page_sz
+                    std::abort();
+                }
+
+                if (config.translator_sz % config.page_sz != 0u || config.translator_sz == 0u || reinterpret_cast<uintptr_t>(config.translator_addr) % config.page_sz != 0u || reinterpret_cast<uintptr_t>(config.translator_addr) / config.page_sz == 0u){ //page_offs != 0, bad practice - but necessary for remapping nullptr
+                    std::abort();
+                }
+
+                if (config.translatee_sz % config.page_sz != 0u || config.translatee_sz == 0u || reinterpret_cast<uintptr_t>(config.translatee_addr) % config.page_sz != 0u || reinterpret_cast<uintptr_t>(config.translatee_addr) / config.page_sz == 0u){ //page_offs != 0, bad practice - but necessary for remapping nullptr
+                    std::abort();
+                }
+
+                if (config.numa_node_count == 0u || config.numa_node_count > MAX_NUMA_NODE_COUNT || config.numa_node_count > config.translatee_sz / config.page_sz){
+                    std::abort();
+                }
+
+                size_t page_shift               = 0u;
+
+                while ((size_t{1} << page_shift) != config.page_sz){
+                    page_shift += 1;
+                }
+
+                size_t translator_page_count    = config.translator_sz / config.page_sz;
+                size_t state_shift              = config.page_table_layout == PageTableLayout::packed ? size_t{0u} : VIRTUAL_PAGE_STATE_BLOCK_SHIFT;
+                size_t leaf_shift               = VIRTUAL_PAGE_LEAF_BLOCK_SHIFT + VIRTUAL_PAGE_STATE_BLOCK_SHIFT - state_shift;
+                size_t leaf_count               = size(translator_page_count - 1, size_t{1} << leaf_shift);
+                size_t translatee_page_count    = config.translatee_sz / config.page_sz;
+                auto translatee_pages           = std::make_unique<PhysicalPageState[]>(translatee_page_count);
+                auto tbl                        = std::make_unique<Table>();
+
+                tbl->virtual_page_directory.leaf_list = static_cast<dg_atomic_type<VirtualPageLeaf *> *>(std::calloc(leaf_count, sizeof(dg_atomic_type<VirtualPageLeaf *>))); //all-zero is a null leaf
+
+                if (tbl->virtual_page_directory.leaf_list == nullptr){
+                    throw std::bad_alloc();
+                }
+
+                tbl->virtual_page_directory.leaf_list_sz = leaf_count;
+
+                if (translatee_page_count >= (size_t{1} << FREE_LIST_LINK_BITCOUNT)){
+                    std::abort();
+                }
+
+                for (size_t i = 0; i < translatee_page_count; ++i){
+                    translatee_pages[i].addr = static_cast<char *>(config.translatee_addr) + (config.page_sz * i); 
+                    dg_atomic_exchange(translatee_pages[i].virtual_page_idx, size_t{0u}, std::memory_order_seq_cst);
+                }
+
+                for (size_t node = 0; node < config.numa_node_count; ++node){ //the partition of a node is spread over the shards of its group
+                    size_t node_first       = numa_partition_first(translatee_page_count, config.numa_node_count, node);
+                    size_t node_last        = numa_partition_first(translatee_page_count, config.numa_node_count, node + 1);
+                    size_t shard_first      = numa_shard_first(config.numa_node_count, node);
+                    size_t shard_last       = numa_shard_first(config.numa_node_count, node + 1);
+                    size_t shard_count      = shard_last - shard_first;
+                    size_t shard_page_count = (node_last - node_first) / shard_count + size_t{(node_last - node_first) % shard_count != 0u};
+
+                    for (size_t i = shard_first; i < shard_last; ++i){ //contiguous block per shard, linked in ascending order
+                        size_t first    = std::min(node_first + (i - shard_first) * shard_page_count, node_last);
+                        size_t last     = std::min(first + shard_page_count, node_last); 
+
+                        for (size_t j = first; j < last; ++j){
+                            dg_atomic_exchange(translatee_pages[j].next, j + 1 == last ? size_t{0u} : j + 2, std::memory_order_seq_cst);
+                        }
+
+                        dg_atomic_exchange(tbl->free_list[i].head, free_list_make_head(first == last ? size_t{0u} : first + 1, 0u), std::memory_order_seq_cst);
+                    }
+                }
+
+                size_t bitmap_word_per_page     = config.dirty_chunk_sz == 0u ? size_t{0u} : size(config.page_sz / config.dirty_chunk_sz - 1, DIRTY_CHUNK_BITMAP_WORD_BITCOUNT);
+                auto bitmap                     = std::make_unique<dg_atomic_type<uint64_t>[]>(bitmap_word_per_page * translatee_page_count);
+
+                for (size_t i = 0; i < bitmap_word_per_page * translatee_page_count; ++i){
+                    dg_atomic_exchange(bitmap[i], uint64_t{0u}, std::memory_order_seq_cst);
+                }
+
+                tbl->config                 = config;
+                tbl->virtual_page_list_sz   = translator_page_count;
+                tbl->page_shift             = page_shift;
+                tbl->virtual_page_state_shift = state_shift;
+                tbl->virtual_page_leaf_shift = leaf_shift;
+                tbl->physical_page_list_sz  = translatee_page_count;
+                tbl->numa_node_count        = config.numa_node_count;
+                tbl->physical_page_list     = std::move(translatee_pages);
+                tbl->thread_cache_registry  = std::make_shared<ThreadCacheRegistry>();
+                tbl->thread_cache_registry->table = tbl.get();
+                tbl->dirty_chunk_bitmap     = std::move(bitmap);
+                tbl->dirty_chunk_bitmap_word_per_page = bitmap_word_per_page;
+
+                if (config.victim_tier_sz != 0u){
+                    tbl->victim_tier = std::make_unique<VictimTier>();
+                    tbl->victim_tier->shard_capacity = config.victim_tier_sz / VICTIM_TIER_SHARD_COUNT;
+
+                    for (auto& shard: tbl->victim_tier->shard_list){
+                        shard.byte_sz = 0u;
+                    }
+                }
+
+                #if defined(__DG_TLB_STATS__)
+                tbl->stat_registry          = std::make_shared<StatRegistry>();
+                #endif
+                for (auto& clock_hand: tbl->clock_hand_list){
+                    dg_atomic_exchange(clock_hand.hand, size_t{0u}, std::memory_order_seq_cst);
+                }
+
+                dg_atomic_exchange(tbl->eviction_epoch, size_t{0u}, std::memory_order_seq_cst);
+                dg_atomic_exchange(tbl->write_back_inflight, size_t{0u}, std::memory_order_seq_cst);
+                dg_atomic_exchange(tbl->parked_waiter_count, size_t{0u}, std::memory_order_seq_cst);
+                dg_atomic_exchange(tbl->transfer_waiter_count, size_t{0u}, std::memory_order_seq_cst);
+                dg_atomic_exchange(tbl->deferred_waiter_count, size_t{0u}, std::memory_order_seq_cst);
+                dg_atomic_exchange(tbl->readahead_last_slot, size_t{0u}, std::memory_order_seq_cst);
+                dg_atomic_exchange(tbl->readahead_stride, size_t{0u}, std::memory_order_seq_cst);
+                dg_atomic_exchange(tbl->prefetch_inflight, size_t{0u}, std::memory_order_seq_cst);
+                dg_atomic_exchange(tbl->thread_cache_pressure, false, std::memory_order_seq_cst);
+                dg_atomic_exchange(tbl->trace.is_enabled, false, std::memory_order_seq_cst);
+                this->table                 = std::move(tbl);
+            }
+
+            TLB(const TLB&) = delete;
+            TLB(TLB&&) noexcept = default;
+            TLB& operator =(const TLB&) = delete;
+
+            TLB& operator =(TLB&& other) noexcept{
+
+                TLB tmp(std::move(other));
+                std::swap(this->table, tmp.table); //previous table is torn down by tmp
+
+                return *this;
+            }
+
+            ~TLB() noexcept{
+
+                if (!this->table){
+                    return;
+                }
+
+                virtual_page_prefetch_wait(*this->table);
+                this->flush();
+                this->trace_stop();
+                thread_cache_detach_all(*this->table);
+            }
+
+            //writable mapping - the whole page is written back on sync/eviction
+            auto map(void * ptr) -> void *{
+
+                return this->map_with_access(ptr, virtual_page_dirty_flag, std::nullopt);
+            } 
+
+            //writable mapping of [ptr, ptr + sz) - the range must not cross the page of ptr. only the chunks spanning the range are written back if sub-page tracking is enabled, the whole page otherwise
+            //writing outside of the range is undefined
+            auto map_write(void * ptr, size_t sz) -> void *{
+
+                return this->map_with_access(ptr, virtual_page_dirty_flag, sz);
+            }
+
+            //read-only mapping - a page that is only ever mapped read-only is dropped on eviction without a write back. writing through it is undefined
+            auto map_readonly(void * ptr) -> void *{
+
+                return this->map_with_access(ptr, 0u, 0u);
+            }
+
+            //map + pin - the page is unmapped when the returned PageRef is destroyed
+            auto map_ref(void * ptr) -> PageRef{
+
+                if (!ptr){
+                    return PageRef();
+                }
+
+                size_t page_slot = table_slot(*this->table, std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr)));
+                return PageRef(this->table.get(), page_slot, this->map(ptr));
+            }
+
+            auto map_ref_readonly(void * ptr) -> PageRef{
+
+                if (!ptr){
+                    return PageRef();
+                }
+
+                size_t page_slot = table_slot(*this->table, std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr)));
+                return PageRef(this->table.get(), page_slot, this->map_readonly(ptr));
+            }
+
+            //writable mapping of [ptr, ptr + sz) across pages - only the covered chunks are written back if sub-page tracking is enabled
+            //the range is readable + writable through the spans of the returned MappedRange (or contiguous() if the physical pages are adjacent) until it is destroyed
+            auto map_range(void * ptr, size_t sz) -> MappedRange{
+
+                return this->map_range_with_access(ptr, sz, virtual_page_dirty_flag);
+            }
+
+            auto map_range_readonly(void * ptr, size_t sz) -> MappedRange{
+
+                return this->map_range_with_access(ptr, sz, 0u);
+            }
+
+            //writable mapping of every in[i], out[i] is the mapped addr of in[i] (null for null) - same as n map()s, but a page is mapped once per call. throw if any could not be mapped, nothing is mapped then
+            //the mappings are released by unmap_batch (or one unmap per pointer)
+            void map_batch(const void * const * in, void ** out, size_t n){
+
+                this->map_batch_with_access(in, out, n, virtual_page_dirty_flag);
+            }
+
+            void map_batch_readonly(const void * const * in, void ** out, size_t n){
+
+                this->map_batch_with_access(in, out, n, 0u);
+            }
+
+            //unmap every in[i] - one cmpexch per distinct page. unlike unmap, the references are never released through the thread cache
+            void unmap_batch(const void * const * in, size_t n) noexcept{
+
+                std::pair<size_t, size_t> slot_buf[TRANSFER_BATCH_PAGE_SZ]; //(slot, run sz) sorted in chunks - no allocation, a page split across chunks is decreased once per chunk
+
+                for (size_t i = 0; i < n;){
+                    size_t slot_sz = 0u;
+
+                    while (i < n && slot_sz < TRANSFER_BATCH_PAGE_SZ){
+                        if (!in[i]){
+                            i += 1;
+                            continue;
+                        }
+
+                        size_t j    = i + 1;
+                        size_t idx  = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(in[i]));
+
+                        while (j < n && in[j] == in[i]){
+                            j += 1;
+                        }
+
+                        for (size_t k = i; k < j; ++k){
+                            trace_record(*this->table, TraceOp::unmap, idx);
+                        }
+
+                        slot_buf[slot_sz++] = {table_slot(*this->table, idx), j - i};
+                        i = j;
+                    }
+
+                    std::sort(slot_buf, slot_buf + slot_sz);
+
+                    for (size_t k = 0; k < slot_sz;){
+                        size_t ref_count    = slot_buf[k].second;
+                        size_t m            = k + 1;
+
+                        while (m < slot_sz && slot_buf[m].first == slot_buf[k].first){
+                            ref_count += slot_buf[m].second;
+                            m += 1;
+                        }
+
+                        virtual_page_dec_ref(*this->table, slot_buf[k].first, ref_count);
+                        k = m;
+                    }
+                }
+            }
+
+            void unmap(void * ptr) noexcept{
+
+                if (!ptr){
+                    return;
+                }
+
+                size_t idx          = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr));
+                size_t page_slot    = table_slot(*this->table, idx);
+                trace_record(*this->table, TraceOp::unmap, idx);
+                virtual_page_unmap(*this->table, page_slot); //must be the mapping thread if thread caches are enabled
+            }
+
+            //write back + unlink the page of ptr - virtual memory of the page may be changed outside of the TLB until it is mapped again
+            void shootdown(void * ptr) noexcept{
+
+                if (!ptr){
+                    return;
+                }
+
+                size_t idx          = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr));
+                size_t page_slot    = table_slot(*this->table, idx);
+                trace_record(*this->table, TraceOp::shootdown, idx);
+                virtual_page_drop(*this->table, page_slot);
+                victim_tier_erase(*this->table, page_slot);
+            }
+
+            //link the pages spanning [ptr, ptr + sz) in the background (on the prefetch executor) without taking a reference - a hint, pages that could not be linked without waiting are skipped
+            //prefetched pages that are never mapped are the first to be evicted
+            void prefetch(void * ptr, size_t sz) noexcept{
+
+                if (!ptr || sz == 0u){
+                    return;
+                }
+
+                size_t idx          = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr));
+                size_t first_slot   = table_slot(*this->table, idx);
+                size_t last_slot    = std::min(table_slot(*this->table, idx + sz - 1) + 1, this->table->virtual_page_list_sz);
+
+                virtual_page_prefetch(*this->table, first_slot, last_slot - first_slot, 1u);
+            }
+
+            void sync(void * ptr) noexcept{
+
+                if (!ptr){
+                    return; 
+                }
+
+                size_t idx          = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr));
+                size_t page_slot    = table_slot(*this->table, idx);
+                trace_record(*this->table, TraceOp::sync, idx);
+                virtual_page_sync(*this->table, page_slot);
+            }
+
+            #if defined(__cpp_lib_coroutine)
+
+            //awaitable map() - ready if the page is linked, the miss runs on executor otherwise (the prefetch executor if empty, inline if neither). an in-flight transfer suspends on a per-page waiter list without holding a thread of executor
+            //the coroutine is resumed through resume_executor once the page is linked (on the filling thread if empty). the reference is never held by a thread cache - release it with unmap_batch
+            //a waiter is never resumed by the thread that publishes the page - a post refused by executor is retried by the next co_map/co_sync or awaitable task of this TLB (inline there if refused again)
+            auto co_map(void * ptr, Executor executor = {}, Executor resume_executor = {}) noexcept -> MapAwaitable{
+
+                return this->co_map_with_access(ptr, virtual_page_dirty_flag, executor, resume_executor);
+            }
+
+            auto co_map_readonly(void * ptr, Executor executor = {}, Executor resume_executor = {}) noexcept -> MapAwaitable{
+
+                return this->co_map_with_access(ptr, 0u, executor, resume_executor);
+            }
+
+            //awaitable sync(ptr) - same executors as co_map
+            auto co_sync(void * ptr, Executor executor = {}, Executor resume_executor = {}) noexcept -> SyncAwaitable{
+
+                if (!ptr){
+                    return SyncAwaitable(nullptr, 0u, {}, {});
+                }
+
+                virtual_page_drain_deferred_waiter(*this->table);
+                size_t idx = std::distance(static_cast<const char *>(this->table->config.translator_addr), static_cast<const char *>(ptr));
+                trace_record(*this->table, TraceOp::sync, idx);
+                return SyncAwaitable(this->table.get(), table_slot(*this->table, idx), executor.post != nullptr ? executor : this->table->config.prefetch_executor, resume_executor);
+            }
+
+            #endif
+
+            void flush() noexcept{
+
+                trace_record(*this->table, TraceOp::flush, 0u);
+                thread_cache_revoke_all(*this->table);
+                virtual_page_drop_all(*this->table);
+                victim_tier_clear(*this->table);
+            }
+
+            void sync() noexcept{
+
+                trace_record(*this->table, TraceOp::sync_all, 0u);
+                thread_cache_revoke_all(*this->table);
+                virtual_page_sync_all(*this->table);
+            }
+
+            //same as flush(), the pages are written back by the calling thread + up to max_concurrency - 1 tasks posted to executor (the prefetch executor if empty, sequential if neither)
+            void flush(Executor executor, size_t max_concurrency) noexcept{
+
+                trace_record(*this->table, TraceOp::flush, 0u);
+                thread_cache_revoke_all(*this->table);
+                virtual_page_parallel_write_back(*this->table, true, executor.post != nullptr ? executor : this->table->config.prefetch_executor, max_concurrency);
+                victim_tier_clear(*this->table);
+            }
+
+            //same as sync(), parallel as flush(executor, max_concurrency)
+            void sync(Executor executor, size_t max_concurrency) noexcept{
+
+                trace_record(*this->table, TraceOp::sync_all, 0u);
+                thread_cache_revoke_all(*this->table);
+                virtual_page_parallel_write_back(*this->table, false, executor.post != nullptr ? executor : this->table->config.prefetch_executor, max_concurrency);
+            }
+
+            //aggregated counters + miss latency histogram of every thread (zero unless __DG_TLB_STATS__ is defined)
+            auto stats() const noexcept -> Stats{
+
+                return stat_snapshot(*this->table);
+            }
+
+            //record every map/unmap/shootdown/sync/flush to sink (see TraceOp) until trace_stop - a running trace is stopped first. sink must stay valid until trace_stop (or destruction, the final flush is recorded)
+            //a mapping taken before trace_start is unmapped in the trace without a map - replays skip unmatched unmaps
+            void trace_start(TraceSink sink){
+
+                dg::flush_on_cap_tlb::trace_start(*this->table, sink);
+            }
+
+            void trace_stop() noexcept{
+
+                dg::flush_on_cap_tlb::trace_stop(*this->table);
+            }
+
+            auto remap(void * old_ptr, void * old_mapped_ptr, void * new_ptr) -> void *{
+
+                //consider branchless - should be compiler's optimization work in the future(if not already now) 
+                if (table_slot(*this->table, reinterpret_cast<uintptr_t>(old_ptr)) == table_slot(*this->table, reinterpret_cast<uintptr_t>(new_ptr))){ 
+                    return static_cast<char *>(old_mapped_ptr) + std::distance(static_cast<const char *>(old_ptr), static_cast<const char *>(new_ptr)); //UB
+                }
+
+                void * rs = this->map(new_ptr);
+                this->unmap(old_ptr);
+                return rs;
+            }
+    };
+
+    static inline std::unique_ptr<TLB> default_tlb; //
+
+    //should be invoked once - at the beginning of the program. a re-init tears down the previous default instance
+    inline void init(const Config& config){
+
+        default_tlb = std::make_unique<TLB>(config);
+    }
+
+    //flush + free the default instance
+    inline void deinit() noexcept{
+
+        default_tlb = nullptr;
+    }
+
+    inline auto map(void * ptr) -> void *{
+
+        return default_tlb->map(ptr);
+    } 
+
+    inline auto map_write(void * ptr, size_t sz) -> void *{
+
+        return default_tlb->map_write(ptr, sz);
+    }
+
+    inline auto map_readonly(void * ptr) -> void *{
+
+        return default_tlb->map_readonly(ptr);
+    }
+
+    inline auto map_ref(void * ptr) -> PageRef{
+
+        return default_tlb->map_ref(ptr);
+    }
+
+    inline auto map_ref_readonly(void * ptr) -> PageRef{
+
+        return default_tlb->map_ref_readonly(ptr);
+    }
+
+    inline auto map_range(void * ptr, size_t sz) -> MappedRange{
+
+        return default_tlb->map_range(ptr, sz);
+    }
+
+    inline auto map_range_readonly(void * ptr, size_t sz) -> MappedRange{
+
+        return default_tlb->map_range_readonly(ptr, sz);
+    }
+
+    inline void map_batch(const void * const * in, void ** out, size_t n){
+
+        default_tlb->map_batch(in, out, n);
+    }
+
+    inline void map_batch_readonly(const void * const * in, void ** out, size_t n){
+
+        default_tlb->map_batch_readonly(in, out, n);
+    }
+
+    inline void unmap_batch(const void * const * in, size_t n) noexcept{
+
+        default_tlb->unmap_batch(in, n);
+    }
+
+    inline void unmap(void * ptr) noexcept{
+
+        default_tlb->unmap(ptr);
+    }
+
+    inline void shootdown(void * ptr) noexcept{
+
+        default_tlb->shootdown(ptr);
+    }
+
+    inline void prefetch(void * ptr, size_t sz) noexcept{
+
+        default_tlb->prefetch(ptr, sz);
+    }
+
+    inline void sync(void * ptr) noexcept{
+
+        default_tlb->sync(ptr);
+    }
+
+    #if defined(__cpp_lib_coroutine)
+
+    inline auto co_map(void * ptr, Executor executor = {}, Executor resume_executor = {}) noexcept -> MapAwaitable{
+
+        return default_tlb->co_map(ptr, executor, resume_executor);
+    }
+
+    inline auto co_map_readonly(void * ptr, Executor executor = {}, Executor resume_executor = {}) noexcept -> MapAwaitable{
+
+        return default_tlb->co_map_readonly(ptr, executor, resume_executor);
+    }
+
+    inline auto co_sync(void * ptr, Executor executor = {}, Executor resume_executor = {}) noexcept -> SyncAwaitable{
+
+        return default_tlb->co_sync(ptr, executor, resume_executor);
+    }
+
+    #endif
+
+    inline void flush() noexcept{
+
+        default_tlb->flush();
+    }
+
+    inline void sync() noexcept{
+
+        default_tlb->sync();
+    }
+
+    inline void flush(Executor executor, size_t max_concurrency) noexcept{
+
+        default_tlb->flush(executor, max_concurrency);
+    }
+
+    inline void sync(Executor executor, size_t max_concurrency) noexcept{
+
+        default_tlb->sync(executor, max_concurrency);
+    }
+
+    inline auto remap(void * old_ptr, void * old_mapped_ptr, void * new_ptr) -> void *{
+
+        return default_tlb->remap(old_ptr, old_mapped_ptr, new_ptr);
+    }
+
+    inline auto stats() noexcept -> Stats{
+
+        return default_tlb->stats();
+    }
+
+    inline void trace_start(TraceSink sink){
+
+        default_tlb->trace_start(sink);
+    }
+
+    inline void trace_stop() noexcept{
+
+        default_tlb->trace_stop();
     }
 
 }
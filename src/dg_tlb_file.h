@@ -0,0 +1,244 @@
+#ifndef __DG_TLB_FILE_H__
+#define __DG_TLB_FILE_H__
+
+//file-backed translator for dg_tlb.h (posix) - the translator range is a PROT_NONE reservation that is never dereferenced, pages are read (fill) + written (write back) through pread/pwrite at (addr - translator_addr)
+//a translator that is only larger than RAM can also be mmap(MAP_SHARED)ed + plugged with a memcpy device - the store avoids the double caching (page cache + translatee pool) + the mmap page faults
+
+#include "dg_tlb.h"
+#include <string>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace dg::flush_on_cap_tlb{
+
+    static inline constexpr size_t DIRECT_IO_ALIGN_SZ = size_t{1} << 12; //buffer, offset + size alignment of O_DIRECT transfers
+
+    //the translator space is the concatenation of segment files of segment_sz bytes each - file i backs [i * segment_sz, (i + 1) * segment_sz). files are created if missing + extended (sparse) to segment_sz
+    //fills of pages that lie in a hole (never written) are zero-filled without a read. is_direct_io transfers the DIRECT_IO_ALIGN_SZ aligned descriptors with O_DIRECT (the others, e.g. sub-page write backs, go through the page cache)
+    //io errors abort - the transfer devices are noexcept. must outlive every TLB it is plugged into
+    class FileTransferStore{
+
+        private:
+
+            struct Segment{
+                int fd;
+                int direct_fd; //-1 if !is_direct_io
+            };
+
+            std::vector<Segment> segment_list;
+            size_t segment_sz;
+            void * reserved_addr;
+            size_t reserved_sz;
+            char * translator_addr;
+
+            static void read_segment(const Segment& segment, char * dst, size_t offs, size_t sz) noexcept{
+
+                off_t data_offs = lseek(segment.fd, static_cast<off_t>(offs), SEEK_DATA);
+
+                if (data_offs == -1 && errno == ENXIO){ //hole up to the end of file
+                    std::memset(dst, 0, sz);
+                    return;
+                }
+
+                if (data_offs != -1 && static_cast<size_t>(data_offs) >= offs + sz){ //hole
+                    std::memset(dst, 0, sz);
+                    return;
+                }
+
+                bool is_direct  = segment.direct_fd != -1 && reinterpret_cast<uintptr_t>(dst) % DIRECT_IO_ALIGN_SZ == 0u && offs % DIRECT_IO_ALIGN_SZ == 0u && sz % DIRECT_IO_ALIGN_SZ == 0u;
+                int fd          = is_direct ? segment.direct_fd : segment.fd;
+
+                while (sz != 0u){
+                    ssize_t rs = pread(fd, dst, sz, static_cast<off_t>(offs));
+
+                    if (rs == -1 && errno == EINTR){
+                        continue;
+                    }
+
+                    if (rs == -1){
+                        std::abort();
+                    }
+
+                    if (rs == 0){ //past the end of file - zero
+                        std::memset(dst, 0, sz);
+                        return;
+                    }
+
+                    dst     += rs;
+                    offs    += static_cast<size_t>(rs);
+                    sz      -= static_cast<size_t>(rs);
+                }
+            }
+
+            static void write_segment(const Segment& segment, const char * src, size_t offs, size_t sz) noexcept{
+
+                bool is_direct  = segment.direct_fd != -1 && reinterpret_cast<uintptr_t>(src) % DIRECT_IO_ALIGN_SZ == 0u && offs % DIRECT_IO_ALIGN_SZ == 0u && sz % DIRECT_IO_ALIGN_SZ == 0u;
+                int fd          = is_direct ? segment.direct_fd : segment.fd;
+
+                while (sz != 0u){
+                    ssize_t rs = pwrite(fd, src, sz, static_cast<off_t>(offs));
+
+                    if (rs == -1 && errno == EINTR){
+                        continue;
+                    }
+
+                    if (rs <= 0){
+                        std::abort();
+                    }
+
+                    src     += rs;
+                    offs    += static_cast<size_t>(rs);
+                    sz      -= static_cast<size_t>(rs);
+                }
+            }
+
+            //split at the segment boundaries - is_read: buf <- [offs, offs + sz), buf -> [offs, offs + sz) otherwise
+            void transfer(char * buf, size_t offs, size_t sz, bool is_read) const noexcept{
+
+                while (sz != 0u){
+                    size_t segment_idx  = offs / this->segment_sz;
+                    size_t segment_offs = offs % this->segment_sz;
+                    size_t transfer_sz  = std::min(sz, this->segment_sz - segment_offs);
+
+                    if (is_read){
+                        read_segment(this->segment_list[segment_idx], buf, segment_offs, transfer_sz);
+                    } else{
+                        write_segment(this->segment_list[segment_idx], buf, segment_offs, transfer_sz);
+                    }
+
+                    buf     += transfer_sz;
+                    offs    += transfer_sz;
+                    sz      -= transfer_sz;
+                }
+            }
+
+            //fill - dst is the physical page, src lies in the translator range
+            static auto submit_read(void * ctx, const TransferDescriptor * descriptor_list, size_t descriptor_sz) noexcept -> transfer_token_t{
+
+                auto * self = static_cast<FileTransferStore *>(ctx);
+
+                for (size_t i = 0; i < descriptor_sz; ++i){
+                    size_t offs = std::distance(static_cast<const char *>(self->translator_addr), static_cast<const char *>(descriptor_list[i].src));
+                    self->transfer(static_cast<char *>(descriptor_list[i].dst), offs, descriptor_list[i].sz, true);
+                }
+
+                return 0u; //completed on submit
+            }
+
+            //write back - dst lies in the translator range, src is the physical page
+            static auto submit_write(void * ctx, const TransferDescriptor * descriptor_list, size_t descriptor_sz) noexcept -> transfer_token_t{
+
+                auto * self = static_cast<FileTransferStore *>(ctx);
+
+                for (size_t i = 0; i < descriptor_sz; ++i){
+                    size_t offs = std::distance(static_cast<const char *>(self->translator_addr), static_cast<const char *>(descriptor_list[i].dst));
+                    self->transfer(const_cast<char *>(static_cast<const char *>(descriptor_list[i].src)), offs, descriptor_list[i].sz, false);
+                }
+
+                return 0u;
+            }
+
+            static void wait(void *, transfer_token_t) noexcept{}
+
+        public:
+
+            //alignment is the page_sz of the TLB - the reserved translator range is aligned to it
+            FileTransferStore(const std::vector<std::string>& path_list, size_t segment_sz, size_t alignment = PAGE_SZ, bool is_direct_io = false): segment_list(),
+                                                                                                                                                   segment_sz(segment_sz),
+                                                                                                                                                   reserved_addr(MAP_FAILED),
+                                                                                                                                                   reserved_sz(0u),
+                                                                                                                                                   translator_addr(nullptr){
+
+                if (path_list.empty() || segment_sz == 0u || alignment == 0u || (alignment & (alignment - 1)) != 0u){
+                    std::abort();
+                }
+
+                for (const auto& path: path_list){
+                    Segment segment{open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644), -1};
+
+                    if (segment.fd == -1){
+                        std::abort();
+                    }
+
+                    struct stat st{};
+
+                    if (fstat(segment.fd, &st) == -1 || (static_cast<size_t>(st.st_size) < segment_sz && ftruncate(segment.fd, static_cast<off_t>(segment_sz)) == -1)){ //extended segments are holes
+                        std::abort();
+                    }
+
+                    if (is_direct_io){
+                        segment.direct_fd = open(path.c_str(), O_RDWR | O_DIRECT | O_CLOEXEC);
+
+                        //-1 on a file system without O_DIRECT - buffered only
+                    }
+
+                    this->segment_list.push_back(segment);
+                }
+
+                this->reserved_sz   = path_list.size() * segment_sz + alignment; //slack for aligning up
+                this->reserved_addr = mmap(nullptr, this->reserved_sz, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0); //address space only - never dereferenced
+
+                if (this->reserved_addr == MAP_FAILED){
+                    std::abort();
+                }
+
+                uintptr_t first         = reinterpret_cast<uintptr_t>(this->reserved_addr);
+                uintptr_t aligned_first = (first + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+                this->translator_addr   = static_cast<char *>(this->reserved_addr) + (aligned_first - first);
+            }
+
+            FileTransferStore(const FileTransferStore&) = delete;
+            FileTransferStore& operator =(const FileTransferStore&) = delete;
+
+            ~FileTransferStore() noexcept{
+
+                for (const auto& segment: this->segment_list){
+                    if (segment.direct_fd != -1){
+                        close(segment.direct_fd);
+                    }
+
+                    fsync(segment.fd);
+                    close(segment.fd);
+                }
+
+                if (this->reserved_addr != MAP_FAILED){
+                    munmap(this->reserved_addr, this->reserved_sz);
+                }
+            }
+
+            auto translator() const noexcept -> char *{
+
+                return this->translator_addr;
+            }
+
+            auto translator_sz() const noexcept -> size_t{
+
+                return this->segment_list.size() * this->segment_sz;
+            }
+
+            //virtual_to_physical_async_transfer_device
+            auto reader() noexcept -> AsyncTransferDevice{
+
+                return AsyncTransferDevice{this, &FileTransferStore::submit_read, &FileTransferStore::wait};
+            }
+
+            //physical_to_virtual_async_transfer_device
+            auto writer() noexcept -> AsyncTransferDevice{
+
+                return AsyncTransferDevice{this, &FileTransferStore::submit_write, &FileTransferStore::wait};
+            }
+
+            //the synchronous mem_transfer_device_t of the TLB are overridden by reader + writer - this one must never be invoked
+            static void unreachable_transfer_device(void *, const void *, size_t) noexcept{
+
+                std::abort();
+            }
+    };
+}
+
+#endif
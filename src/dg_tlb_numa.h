@@ -0,0 +1,179 @@
+#ifndef __DG_TLB_NUMA_H__
+#define __DG_TLB_NUMA_H__
+
+//node-partitioned translatee for dg_tlb.h (linux) - one anonymous mapping split into the numa_partition_first partitions of the TLB, partition i is bound to node i (mbind, preferred) before first touch + backed by huge pages if asked
+//plug translatee() + translatee_sz() as the translatee and node_count() as the numa_node_count of the TLB. every step degrades silently - no mbind (single node kernels) leaves first-touch placement, no huge page pool leaves base pages
+
+#include "dg_tlb.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace dg::flush_on_cap_tlb{
+
+    static inline constexpr size_t HUGE_PAGE_SZ         = size_t{1} << 21; //default huge page size of x86_64 + aarch64 (4KiB granule)
+    static inline constexpr int NUMA_MPOL_PREFERRED     = 1; //linux/mempolicy.h - mbind is invoked through syscall, no libnuma dependency
+    static inline constexpr size_t NUMA_NODE_MASK_WORD_COUNT = MAX_NUMA_NODE_COUNT / (sizeof(unsigned long) * CHAR_BIT) + 1u;
+
+    enum class HugePagePolicy{
+        none,
+        transparent, //madvise(MADV_HUGEPAGE) - the kernel backs the aligned 2MiB runs with huge pages when it can
+        hugetlb //MAP_HUGETLB from the reserved pool (vm.nr_hugepages) - transparent if the pool is short
+    };
+
+    //highest online node + 1 (clamped to MAX_NUMA_NODE_COUNT), 1 if unknown. /sys/devices/system/node/online is a range list - "0", "0-1", "0,2-3"
+    inline auto numa_node_count_detect() noexcept -> size_t{
+
+        int fd = open("/sys/devices/system/node/online", O_RDONLY | O_CLOEXEC);
+
+        if (fd == -1){
+            return 1u;
+        }
+
+        char buf[256]{};
+        ssize_t rs = read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+
+        if (rs <= 0){
+            return 1u;
+        }
+
+        size_t max_node = 0u;
+        size_t cur      = 0u;
+
+        for (ssize_t i = 0; i <= rs; ++i){
+            if (i < rs && buf[i] >= '0' && buf[i] <= '9'){
+                cur = cur * 10u + static_cast<size_t>(buf[i] - '0');
+                continue;
+            }
+
+            max_node    = std::max(max_node, cur);
+            cur         = 0u;
+        }
+
+        return std::min(max_node + 1, MAX_NUMA_NODE_COUNT);
+    }
+
+    //owns the translatee mapping - must outlive every TLB it is plugged into
+    class NumaTranslatee{
+
+        private:
+
+            void * mapped_addr;
+            size_t mapped_sz;
+            char * translatee_addr;
+            size_t translatee_byte_sz;
+            size_t partition_node_count;
+            bool is_hugetlb_backed;
+
+            //prefer node for [addr, addr + sz) - pages are placed on first touch, falling back to the other nodes if node is full. false if the kernel refused (no NUMA, unaligned hugetlb range)
+            static auto bind(void * addr, size_t sz, size_t node) noexcept -> bool{
+
+                #if defined(SYS_mbind)
+                constexpr size_t WORD_BITCOUNT = sizeof(unsigned long) * CHAR_BIT;
+                unsigned long node_mask[NUMA_NODE_MASK_WORD_COUNT]{};
+                node_mask[node / WORD_BITCOUNT] |= 1ul << (node % WORD_BITCOUNT);
+
+                return syscall(SYS_mbind, addr, sz, NUMA_MPOL_PREFERRED, node_mask, NUMA_NODE_MASK_WORD_COUNT * WORD_BITCOUNT, 0u) == 0;
+                #else
+                (void) addr;
+                (void) sz;
+                (void) node;
+                return false;
+                #endif
+            }
+
+        public:
+
+            //sz is the translatee size - a multiple of page_sz (the page_sz of the TLB, the translatee is aligned to it). node_count is clamped to the page count
+            NumaTranslatee(size_t sz, size_t page_sz = PAGE_SZ, size_t node_count = numa_node_count_detect(), HugePagePolicy huge_page_policy = HugePagePolicy::transparent): mapped_addr(MAP_FAILED),
+                                                                                                                                                                            mapped_sz(0u),
+                                                                                                                                                                            translatee_addr(nullptr),
+                                                                                                                                                                            translatee_byte_sz(sz),
+                                                                                                                                                                            partition_node_count(1u),
+                                                                                                                                                                            is_hugetlb_backed(false){
+
+                if (sz == 0u || page_sz == 0u || (page_sz & (page_sz - 1)) != 0u || sz % page_sz != 0u || node_count == 0u){
+                    std::abort();
+                }
+
+                this->partition_node_count  = std::min(std::min(node_count, MAX_NUMA_NODE_COUNT), sz / page_sz);
+                size_t alignment            = huge_page_policy == HugePagePolicy::none ? page_sz : std::max(page_sz, HUGE_PAGE_SZ);
+
+                #if defined(MAP_HUGETLB)
+                if (huge_page_policy == HugePagePolicy::hugetlb){
+                    size_t hugetlb_sz       = (sz + (alignment - HUGE_PAGE_SZ) + HUGE_PAGE_SZ - 1) & ~(HUGE_PAGE_SZ - 1); //a hugetlb mapping is HUGE_PAGE_SZ aligned - slack for aligning up to page_sz
+                    this->mapped_addr       = mmap(nullptr, hugetlb_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0); //reserved up front - fails (instead of SIGBUS on touch) if the pool is short
+                    this->mapped_sz         = hugetlb_sz;
+                    this->is_hugetlb_backed = this->mapped_addr != MAP_FAILED;
+                }
+                #endif
+
+                if (this->mapped_addr == MAP_FAILED){
+                    this->mapped_sz     = sz + alignment; //slack for aligning up
+                    this->mapped_addr   = mmap(nullptr, this->mapped_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+                    if (this->mapped_addr == MAP_FAILED){
+                        std::abort();
+                    }
+
+                    #if defined(MADV_HUGEPAGE)
+                    if (huge_page_policy != HugePagePolicy::none){
+                        madvise(this->mapped_addr, this->mapped_sz, MADV_HUGEPAGE); //advisory - ignored without THP
+                    }
+                    #endif
+                }
+
+                uintptr_t first         = reinterpret_cast<uintptr_t>(this->mapped_addr);
+                uintptr_t aligned_first = (first + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1); //huge page aligned unless HugePagePolicy::none
+                this->translatee_addr   = static_cast<char *>(this->mapped_addr) + (aligned_first - first);
+
+                if (this->partition_node_count == 1u){
+                    return;
+                }
+
+                size_t page_count = sz / page_sz;
+
+                for (size_t node = 0; node < this->partition_node_count; ++node){ //same partitions as the free lists of the TLB
+                    size_t first_page   = numa_partition_first(page_count, this->partition_node_count, node);
+                    size_t last_page    = numa_partition_first(page_count, this->partition_node_count, node + 1);
+                    bind(this->translatee_addr + first_page * page_sz, (last_page - first_page) * page_sz, node);
+                }
+            }
+
+            NumaTranslatee(const NumaTranslatee&) = delete;
+            NumaTranslatee& operator =(const NumaTranslatee&) = delete;
+
+            ~NumaTranslatee() noexcept{
+
+                if (this->mapped_addr != MAP_FAILED){
+                    munmap(this->mapped_addr, this->mapped_sz);
+                }
+            }
+
+            auto translatee() const noexcept -> char *{
+
+                return this->translatee_addr;
+            }
+
+            auto translatee_sz() const noexcept -> size_t{
+
+                return this->translatee_byte_sz;
+            }
+
+            //numa_node_count of the TLB
+            auto node_count() const noexcept -> size_t{
+
+                return this->partition_node_count;
+            }
+
+            //false if backed by base pages (+ transparent huge pages if asked)
+            auto is_hugetlb() const noexcept -> bool{
+
+                return this->is_hugetlb_backed;
+            }
+    };
+}
+
+#endif
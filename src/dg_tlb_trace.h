@@ -0,0 +1,142 @@
+#ifndef __DG_TLB_TRACE_H__
+#define __DG_TLB_TRACE_H__
+
+//trace file sink + reader for dg_tlb.h (posix) - a trace file is one TraceHeader followed by the TraceRecords in sink order (per shard in call order, shards interleaved)
+//replay.cpp replays a trace file against the engine or a pure simulation with another page size, pool size or eviction policy
+
+#include "dg_tlb.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace dg::flush_on_cap_tlb{
+
+    //appends the records of one trace (trace_start .. trace_stop) to path, truncated on open. io errors abort - the sink is noexcept. must outlive the trace
+    class TraceFileWriter{
+
+        private:
+
+            int fd;
+            std::mutex mtx; //shards are drained concurrently - one write per batch, so records of a batch stay contiguous
+
+            void write_all(const char * src, size_t sz) noexcept{
+
+                while (sz != 0u){
+                    ssize_t rs = ::write(this->fd, src, sz);
+
+                    if (rs == -1 && errno == EINTR){
+                        continue;
+                    }
+
+                    if (rs <= 0){
+                        std::abort();
+                    }
+
+                    src += rs;
+                    sz  -= static_cast<size_t>(rs);
+                }
+            }
+
+            static void write_header(void * ctx, const TraceHeader& header) noexcept{
+
+                auto * self = static_cast<TraceFileWriter *>(ctx);
+                std::lock_guard<std::mutex> lck_grd(self->mtx);
+
+                if (lseek(self->fd, 0, SEEK_SET) == -1 || ftruncate(self->fd, 0) == -1){ //a sink restarted by another trace_start holds the latest trace only
+                    std::abort();
+                }
+
+                self->write_all(reinterpret_cast<const char *>(&header), sizeof(TraceHeader));
+            }
+
+            static void write_record(void * ctx, const TraceRecord * record_list, size_t record_sz) noexcept{
+
+                auto * self = static_cast<TraceFileWriter *>(ctx);
+                std::lock_guard<std::mutex> lck_grd(self->mtx);
+                self->write_all(reinterpret_cast<const char *>(record_list), record_sz * sizeof(TraceRecord));
+            }
+
+        public:
+
+            explicit TraceFileWriter(const std::string& path): fd(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)),
+                                                               mtx(){
+
+                if (this->fd == -1){
+                    std::abort();
+                }
+            }
+
+            TraceFileWriter(const TraceFileWriter&) = delete;
+            TraceFileWriter& operator =(const TraceFileWriter&) = delete;
+
+            ~TraceFileWriter() noexcept{
+
+                fsync(this->fd);
+                close(this->fd);
+            }
+
+            auto sink() noexcept -> TraceSink{
+
+                return TraceSink{this, &TraceFileWriter::write_header, &TraceFileWriter::write_record};
+            }
+    };
+
+    //read a trace file written by TraceFileWriter - the records are stable-sorted by timestamp (the call order of each thread is kept). false if the file is missing, truncated or not a trace of this version
+    inline auto trace_read(const std::string& path, TraceHeader& header, std::vector<TraceRecord>& record_list) -> bool{
+
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd == -1){
+            return false;
+        }
+
+        std::vector<char> buf{};
+        char chunk[size_t{1} << 16];
+
+        while (true){
+            ssize_t rs = read(fd, chunk, sizeof(chunk));
+
+            if (rs == -1 && errno == EINTR){
+                continue;
+            }
+
+            if (rs == -1){
+                close(fd);
+                return false;
+            }
+
+            if (rs == 0){
+                break;
+            }
+
+            buf.insert(buf.end(), chunk, chunk + rs);
+        }
+
+        close(fd);
+
+        if (buf.size() < sizeof(TraceHeader) || (buf.size() - sizeof(TraceHeader)) % sizeof(TraceRecord) != 0u){
+            return false;
+        }
+
+        std::memcpy(&header, buf.data(), sizeof(TraceHeader));
+
+        if (header.magic != TRACE_MAGIC || header.version != TRACE_VERSION || header.page_sz == 0u || (header.page_sz & (header.page_sz - 1)) != 0u){
+            return false;
+        }
+
+        record_list.resize((buf.size() - sizeof(TraceHeader)) / sizeof(TraceRecord));
+
+        if (!record_list.empty()){
+            std::memcpy(record_list.data(), buf.data() + sizeof(TraceHeader), record_list.size() * sizeof(TraceRecord));
+        }
+
+        std::stable_sort(record_list.begin(), record_list.end(), [](const TraceRecord& lhs, const TraceRecord& rhs){return lhs.timestamp < rhs.timestamp;});
+
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,808 @@
+//replay a trace (TLB::trace_start + TraceFileWriter) against another configuration - the engine (a TLB over an anonymous translator) or a pure simulation of the page pool
+//g++ -std=c++17 -O2 -pthread replay.cpp -o replay
+//./replay --trace tlb.trace --mode sim --physical_pages 128 --policy clock > replay.json
+//./replay --trace tlb.trace --mode engine --page_sz 65536 --physical_pages 2048 --thread_cache 1 > replay.json
+//
+//the records are replayed on one thread in timestamp order (deterministic). a map of the recorded page size maps the replay pages spanning [offs, offs + sz) (the page of offs if sz is page_sz or 0), its unmap releases the same pages
+//an unmap without a recorded map (mapped before trace_start) is skipped. sync/shootdown of a page that is still mapped run once it is unmapped (the recording thread waited for the other threads), so do flush + sync_all page by page
+//the replay ends with a flush - the final write backs are counted. the modeled latency of a call is hit_ns if it transferred nothing, transfer_us per transfer + bytes / bandwidth_mbps otherwise
+//the engine options (thread cache, dirty chunk, readahead, page table layout, numa nodes) default to the recorded ones - sim ignores them + warns if one is passed
+//the victim tier defaults to off (victim_tier_sz 0) whatever was recorded - the replayed translator is all zero, so every evicted page would compress + refill from the tier. pass --victim_tier_sz to model one (a refill from the tier transfers nothing - it counts as a hit)
+//the json "engine" object carries the applied victim_tier_sz next to the recorded_victim_tier_sz
+//engine readahead runs inline on the replay thread (no prefetch executor), so the replay stays deterministic - the recorded prefetch executor is not modeled
+
+#include "dg_tlb_trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <optional>
+#include <algorithm>
+#include <atomic>
+#include <sys/mman.h>
+
+namespace replay{
+
+    using namespace dg::flush_on_cap_tlb;
+
+    enum class Mode{
+        engine,
+        sim
+    };
+
+    struct Option{
+        std::string trace_path                           = {};
+        Mode mode                                        = Mode::sim;
+        size_t page_sz                                   = 0u; //0 denotes the recorded page size
+        size_t physical_page_count                       = 0u; //0 denotes the recorded translatee size
+        std::optional<EvictionPolicy> eviction_policy    = std::nullopt; //the recorded policy if empty
+        std::optional<bool> thread_cache_enabled         = std::nullopt; //engine only, the recorded one if empty (same for the options below)
+        std::optional<size_t> dirty_chunk_sz             = std::nullopt;
+        std::optional<size_t> readahead_page_count       = std::nullopt;
+        std::optional<PageTableLayout> page_table_layout = std::nullopt;
+        std::optional<size_t> victim_tier_sz             = std::nullopt; //0 if empty, not the recorded one - the replayed translator is all zero, every evicted page compresses
+        std::optional<size_t> numa_node_count            = std::nullopt; //the translatee is one allocation - only the pool partitioning is modeled
+        double hit_ns                                    = 50.0;
+        double transfer_us                               = 100.0;
+        double bandwidth_mbps                            = 1000.0;
+    };
+
+    //the resolved engine options - see engine_config
+    struct EngineConfig{
+        bool thread_cache_enabled;
+        size_t dirty_chunk_sz;
+        size_t readahead_page_count;
+        PageTableLayout page_table_layout;
+        size_t victim_tier_sz;
+        size_t numa_node_count;
+    };
+
+    struct TransferCounter{
+        std::atomic<size_t> fill_count{};
+        std::atomic<size_t> fill_byte{};
+        std::atomic<size_t> write_back_count{};
+        std::atomic<size_t> write_back_byte{};
+    };
+
+    static inline TransferCounter transfer_counter{};
+
+    void fill_device(void * dst, const void * src, size_t sz) noexcept{
+
+        memcpy(dst, src, sz);
+        transfer_counter.fill_count.fetch_add(1u, std::memory_order_relaxed);
+        transfer_counter.fill_byte.fetch_add(sz, std::memory_order_relaxed);
+    }
+
+    void write_back_device(void * dst, const void * src, size_t sz) noexcept{
+
+        memcpy(dst, src, sz);
+        transfer_counter.write_back_count.fetch_add(1u, std::memory_order_relaxed);
+        transfer_counter.write_back_byte.fetch_add(sz, std::memory_order_relaxed);
+    }
+
+    auto parse_mode(const std::string& arg) -> Mode{
+
+        if (arg == "engine")    return Mode::engine;
+        if (arg == "sim")       return Mode::sim;
+
+        fprintf(stderr, "unknown mode %s\n", arg.c_str());
+        std::exit(1);
+    }
+
+    auto parse_policy(const std::string& arg) -> EvictionPolicy{
+
+        if (arg == "flush_zero_ref")    return EvictionPolicy::flush_zero_ref;
+        if (arg == "clock")             return EvictionPolicy::clock;
+        if (arg == "clock_cold_insert") return EvictionPolicy::clock_cold_insert;
+
+        fprintf(stderr, "unknown eviction policy %s\n", arg.c_str());
+        std::exit(1);
+    }
+
+    auto policy_name(EvictionPolicy policy) -> const char *{
+
+        switch (policy){
+            case EvictionPolicy::flush_zero_ref:    return "flush_zero_ref";
+            case EvictionPolicy::clock:             return "clock";
+            case EvictionPolicy::clock_cold_insert: return "clock_cold_insert";
+        }
+
+        return "";
+    }
+
+    auto parse_layout(const std::string& arg) -> PageTableLayout{
+
+        if (arg == "padded")    return PageTableLayout::padded;
+        if (arg == "packed")    return PageTableLayout::packed;
+
+        fprintf(stderr, "unknown page table layout %s\n", arg.c_str());
+        std::exit(1);
+    }
+
+    auto layout_name(PageTableLayout layout) -> const char *{
+
+        switch (layout){
+            case PageTableLayout::padded:   return "padded";
+            case PageTableLayout::packed:   return "packed";
+        }
+
+        return "";
+    }
+
+    auto parse_option(int argc, char ** argv) -> Option{
+
+        Option option{};
+
+        for (int i = 1; i + 1 < argc; i += 2){
+            std::string key = argv[i];
+            std::string val = argv[i + 1];
+
+            if (key == "--trace")                       option.trace_path = val;
+            else if (key == "--mode")                   option.mode = parse_mode(val);
+            else if (key == "--page_sz")                option.page_sz = std::stoull(val);
+            else if (key == "--physical_pages")         option.physical_page_count = std::stoull(val);
+            else if (key == "--policy")                 option.eviction_policy = parse_policy(val);
+            else if (key == "--thread_cache")           option.thread_cache_enabled = std::stoull(val) != 0u;
+            else if (key == "--dirty_chunk_sz")         option.dirty_chunk_sz = std::stoull(val);
+            else if (key == "--readahead_pages")        option.readahead_page_count = std::stoull(val);
+            else if (key == "--victim_tier_sz")         option.victim_tier_sz = std::stoull(val);
+            else if (key == "--layout")                 option.page_table_layout = parse_layout(val);
+            else if (key == "--numa_nodes")             option.numa_node_count = std::stoull(val);
+            else if (key == "--hit_ns")                 option.hit_ns = std::stod(val);
+            else if (key == "--transfer_us")            option.transfer_us = std::stod(val);
+            else if (key == "--bandwidth_mbps")         option.bandwidth_mbps = std::stod(val);
+            else{
+                fprintf(stderr, "unknown option %s\n", key.c_str());
+                std::exit(1);
+            }
+        }
+
+        if (option.trace_path.empty()){
+            fprintf(stderr, "missing --trace\n");
+            std::exit(1);
+        }
+
+        if (option.mode == Mode::sim){
+            std::pair<bool, const char *> engine_only_list[] = {{option.thread_cache_enabled.has_value(), "--thread_cache"}, {option.dirty_chunk_sz.has_value(), "--dirty_chunk_sz"}, {option.readahead_page_count.has_value(), "--readahead_pages"},
+                                                                {option.page_table_layout.has_value(), "--layout"}, {option.victim_tier_sz.has_value(), "--victim_tier_sz"}, {option.numa_node_count.has_value(), "--numa_nodes"}};
+
+            for (const auto& [is_given, name]: engine_only_list){
+                if (is_given){
+                    fprintf(stderr, "warning: %s is engine only - ignored by --mode sim\n", name);
+                }
+            }
+        }
+
+        return option;
+    }
+
+    //the engine options of the replay - the passed ones, the recorded ones otherwise (the victim tier is off unless passed). a recorded option the replay geometry cannot take is clamped (dirty chunk above page_sz tracks whole pages, numa nodes above the pool size)
+    auto engine_config(const Option& option, const TraceHeader& header, size_t page_sz, size_t physical_page_count) -> EngineConfig{
+
+        if (!option.page_table_layout && header.page_table_layout > static_cast<uint64_t>(PageTableLayout::packed)){
+            fprintf(stderr, "unknown recorded page table layout %zu - pass --layout\n", static_cast<size_t>(header.page_table_layout));
+            std::exit(1);
+        }
+
+        size_t recorded_dirty_chunk_sz  = header.dirty_chunk_sz > page_sz ? size_t{0u} : static_cast<size_t>(header.dirty_chunk_sz);
+        size_t recorded_numa_node_count = std::clamp(static_cast<size_t>(header.numa_node_count), size_t{1u}, std::min(MAX_NUMA_NODE_COUNT, physical_page_count));
+
+        EngineConfig config{option.thread_cache_enabled.value_or(header.thread_cache_enabled != 0u),
+                            option.dirty_chunk_sz.value_or(recorded_dirty_chunk_sz),
+                            option.readahead_page_count.value_or(static_cast<size_t>(header.readahead_page_count)),
+                            option.page_table_layout.value_or(static_cast<PageTableLayout>(header.page_table_layout)),
+                            option.victim_tier_sz.value_or(size_t{0u}),
+                            option.numa_node_count.value_or(recorded_numa_node_count)};
+
+        if (config.dirty_chunk_sz != 0u && (config.dirty_chunk_sz > page_sz || (config.dirty_chunk_sz & (config.dirty_chunk_sz - 1)) != 0u)){
+            fprintf(stderr, "dirty_chunk_sz must be 0 or a pow2 <= page_sz\n");
+            std::exit(1);
+        }
+
+        if (config.numa_node_count == 0u || config.numa_node_count > std::min(MAX_NUMA_NODE_COUNT, physical_page_count)){
+            fprintf(stderr, "numa_nodes must be in [1, min(%zu, physical_pages)]\n", MAX_NUMA_NODE_COUNT);
+            std::exit(1);
+        }
+
+        return config;
+    }
+
+    //a TLB over an anonymous (zero, lazily committed) translator of the recorded size - the transfers are real copies. no prefetch executor - readahead runs inline on the replay thread
+    class EngineBackend{
+
+        private:
+
+            size_t page_sz;
+            void * reserved_addr;
+            size_t reserved_sz;
+            char * translator;
+            char * translatee;
+            std::unique_ptr<TLB> tlb;
+
+            auto page_ptr(size_t page) const noexcept -> char *{
+
+                return this->translator + page * this->page_sz;
+            }
+
+        public:
+
+            EngineBackend(const EngineConfig& config, size_t page_sz, size_t virtual_page_count, size_t physical_page_count, EvictionPolicy eviction_policy): page_sz(page_sz),
+                                                                                                                                                               reserved_addr(MAP_FAILED),
+                                                                                                                                                               reserved_sz(0u),
+                                                                                                                                                               translator(nullptr),
+                                                                                                                                                               translatee(nullptr),
+                                                                                                                                                               tlb(){
+
+                this->reserved_sz   = (virtual_page_count + 1) * page_sz; //slack for aligning up
+                this->reserved_addr = mmap(nullptr, this->reserved_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+                this->translatee    = static_cast<char *>(aligned_alloc(page_sz, physical_page_count * page_sz));
+
+                if (this->reserved_addr == MAP_FAILED || !this->translatee){
+                    fprintf(stderr, "out of memory\n");
+                    std::exit(1);
+                }
+
+                uintptr_t first     = reinterpret_cast<uintptr_t>(this->reserved_addr);
+                this->translator    = static_cast<char *>(this->reserved_addr) + (((first + page_sz - 1) & ~static_cast<uintptr_t>(page_sz - 1)) - first);
+
+                Config tlb_config{};
+                tlb_config.translator_addr                      = this->translator;
+                tlb_config.translator_sz                        = virtual_page_count * page_sz;
+                tlb_config.translatee_addr                      = this->translatee;
+                tlb_config.translatee_sz                        = physical_page_count * page_sz;
+                tlb_config.virtual_to_physical_transfer_device  = fill_device;
+                tlb_config.physical_to_virtual_transfer_device  = write_back_device;
+                tlb_config.eviction_policy                      = eviction_policy;
+                tlb_config.thread_cache_enabled                 = config.thread_cache_enabled;
+                tlb_config.dirty_chunk_sz                       = config.dirty_chunk_sz;
+                tlb_config.readahead_page_count                 = config.readahead_page_count;
+                tlb_config.page_sz                              = page_sz;
+                tlb_config.page_table_layout                    = config.page_table_layout;
+                tlb_config.victim_tier_sz                       = config.victim_tier_sz;
+                tlb_config.numa_node_count                      = config.numa_node_count;
+                this->tlb                                       = std::make_unique<TLB>(tlb_config);
+            }
+
+            EngineBackend(const EngineBackend&) = delete;
+            EngineBackend& operator =(const EngineBackend&) = delete;
+
+            ~EngineBackend() noexcept{
+
+                this->tlb = nullptr;
+                free(this->translatee);
+                munmap(this->reserved_addr, this->reserved_sz);
+            }
+
+            //false if no page could be acquired
+            auto map(size_t page, bool is_write) -> bool{
+
+                try{
+                    if (is_write){
+                        this->tlb->map(this->page_ptr(page));
+                    } else{
+                        this->tlb->map_readonly(this->page_ptr(page));
+                    }
+                } catch (no_page_found&){
+                    return false;
+                }
+
+                return true;
+            }
+
+            void unmap(size_t page) noexcept{
+
+                this->tlb->unmap(this->page_ptr(page));
+            }
+
+            void shootdown(size_t page) noexcept{
+
+                this->tlb->shootdown(this->page_ptr(page));
+            }
+
+            void sync(size_t page) noexcept{
+
+                this->tlb->sync(this->page_ptr(page));
+            }
+
+            void sync_all() noexcept{
+
+                this->tlb->sync();
+            }
+
+            void flush() noexcept{
+
+                this->tlb->flush();
+            }
+    };
+
+    //the page pool without data - same replacement as the engine (flush_zero_ref, CLOCK with or without the reference bit on link), whole pages are transferred (no sub-page tracking, victim tier or readahead)
+    class SimBackend{
+
+        private:
+
+            struct Frame{
+                size_t page; //SIZE_MAX denotes free
+                size_t ref;
+                bool is_referenced;
+                bool is_dirty;
+            };
+
+            size_t page_sz;
+            EvictionPolicy eviction_policy;
+            std::vector<Frame> frame_list;
+            std::vector<size_t> free_list;
+            std::unordered_map<size_t, size_t> page_table; //page -> frame
+            size_t hand;
+
+            void write_back(Frame& frame) noexcept{
+
+                if (frame.is_dirty){
+                    transfer_counter.write_back_count.fetch_add(1u, std::memory_order_relaxed);
+                    transfer_counter.write_back_byte.fetch_add(this->page_sz, std::memory_order_relaxed);
+                    frame.is_dirty = false;
+                }
+            }
+
+            void unlink(size_t frame_idx){
+
+                Frame& frame = this->frame_list[frame_idx];
+                this->write_back(frame);
+                this->page_table.erase(frame.page);
+                frame.page = SIZE_MAX;
+                this->free_list.push_back(frame_idx);
+            }
+
+            auto try_evict() -> bool{
+
+                if (this->eviction_policy == EvictionPolicy::flush_zero_ref){
+                    for (size_t i = 0; i < this->frame_list.size(); ++i){
+                        if (this->frame_list[i].page != SIZE_MAX && this->frame_list[i].ref == 0u){
+                            this->unlink(i);
+                        }
+                    }
+
+                    return !this->free_list.empty();
+                }
+
+                for (size_t i = 0; i < 2u * this->frame_list.size(); ++i){ //the first lap may only clear reference bits
+                    size_t frame_idx    = this->hand++ % this->frame_list.size();
+                    Frame& frame        = this->frame_list[frame_idx];
+
+                    if (frame.ref != 0u){
+                        continue;
+                    }
+
+                    if (frame.is_referenced){
+                        frame.is_referenced = false;
+                        continue;
+                    }
+
+                    this->unlink(frame_idx);
+                    return true;
+                }
+
+                return false;
+            }
+
+        public:
+
+            SimBackend(size_t page_sz, size_t physical_page_count, EvictionPolicy eviction_policy): page_sz(page_sz),
+                                                                                                    eviction_policy(eviction_policy),
+                                                                                                    frame_list(physical_page_count, Frame{SIZE_MAX, 0u, false, false}),
+                                                                                                    free_list(),
+                                                                                                    page_table(),
+                                                                                                    hand(0u){
+
+                for (size_t i = physical_page_count; i != 0u; --i){
+                    this->free_list.push_back(i - 1);
+                }
+            }
+
+            auto map(size_t page, bool is_write) -> bool{
+
+                if (auto it = this->page_table.find(page); it != this->page_table.end()){
+                    Frame& frame        = this->frame_list[it->second];
+                    frame.ref          += 1;
+                    frame.is_referenced = true;
+                    frame.is_dirty      = frame.is_dirty || is_write;
+                    return true;
+                }
+
+                if (this->free_list.empty() && !this->try_evict()){
+                    return false;
+                }
+
+                size_t frame_idx    = this->free_list.back();
+                this->free_list.pop_back();
+                this->frame_list[frame_idx] = Frame{page, 1u, this->eviction_policy != EvictionPolicy::clock_cold_insert, is_write};
+                this->page_table.emplace(page, frame_idx);
+                transfer_counter.fill_count.fetch_add(1u, std::memory_order_relaxed);
+                transfer_counter.fill_byte.fetch_add(this->page_sz, std::memory_order_relaxed);
+
+                return true;
+            }
+
+            void unmap(size_t page) noexcept{
+
+                if (auto it = this->page_table.find(page); it != this->page_table.end() && this->frame_list[it->second].ref != 0u){
+                    this->frame_list[it->second].ref -= 1;
+                }
+            }
+
+            void shootdown(size_t page){
+
+                if (auto it = this->page_table.find(page); it != this->page_table.end()){
+                    this->unlink(it->second);
+                }
+            }
+
+            void sync(size_t page) noexcept{
+
+                if (auto it = this->page_table.find(page); it != this->page_table.end()){
+                    this->write_back(this->frame_list[it->second]);
+                }
+            }
+
+            void sync_all() noexcept{
+
+                for (auto& frame: this->frame_list){
+                    this->write_back(frame);
+                }
+            }
+
+            void flush(){
+
+                for (size_t i = 0; i < this->frame_list.size(); ++i){
+                    if (this->frame_list[i].page != SIZE_MAX){
+                        this->unlink(i);
+                    }
+                }
+            }
+    };
+
+    struct Result{
+        size_t map_count            = 0u;
+        size_t hit_count            = 0u;
+        size_t no_page_found        = 0u;
+        size_t unmatched_unmap      = 0u;
+        size_t deferred_op          = 0u; //sync + shootdown that waited for an unmap
+        double modeled_ns           = 0.0;
+        std::vector<double> modeled_map_ns_list;
+    };
+
+    struct Mapping{
+        uint16_t thread_id;
+        size_t first_page;
+        size_t last_page;
+    };
+
+    //replays the records against backend - the reference + pending bookkeeping is the same for both backends, so they see the same call sequence
+    template <class Backend>
+    class Replayer{
+
+        private:
+
+            static inline constexpr uint8_t PENDING_SYNC        = 1u;
+            static inline constexpr uint8_t PENDING_SHOOTDOWN   = 2u;
+
+            const Option& option;
+            Backend& backend;
+            size_t recorded_page_sz;
+            size_t page_sz;
+            size_t virtual_page_count;
+            std::unordered_map<size_t, std::deque<Mapping>> mapping_map; //recorded slot -> mappings in map order
+            std::unordered_map<size_t, size_t> ref_map; //replay page -> references held by the replay
+            std::unordered_map<size_t, uint8_t> pending_map; //replay page -> ops waiting for ref 0
+            std::unordered_set<size_t> touched_set; //replay pages mapped at least once
+            Result result;
+
+            auto transferred_ns(size_t transfer_count, size_t byte_sz) const noexcept -> double{
+
+                if (transfer_count == 0u){
+                    return this->option.hit_ns;
+                }
+
+                return static_cast<double>(transfer_count) * this->option.transfer_us * 1e3 + static_cast<double>(byte_sz) * 1e3 / this->option.bandwidth_mbps; //MB/s == bytes/us
+            }
+
+            //run fn + charge the modeled latency of its transfers
+            template <class Fn>
+            auto charge(Fn fn) -> double{
+
+                size_t transfer_count   = transfer_counter.fill_count.load() + transfer_counter.write_back_count.load();
+                size_t byte_sz          = transfer_counter.fill_byte.load() + transfer_counter.write_back_byte.load();
+                fn();
+                double ns               = this->transferred_ns(transfer_counter.fill_count.load() + transfer_counter.write_back_count.load() - transfer_count, transfer_counter.fill_byte.load() + transfer_counter.write_back_byte.load() - byte_sz);
+                this->result.modeled_ns += ns;
+
+                return ns;
+            }
+
+            void run_pending(size_t page, uint8_t pending){
+
+                if (pending & PENDING_SHOOTDOWN){
+                    this->charge([&]{this->backend.shootdown(page);});
+                } else{
+                    this->charge([&]{this->backend.sync(page);});
+                }
+            }
+
+            //run op now if page is not mapped by the replay, once its last reference is released otherwise
+            void run_or_defer(size_t page, uint8_t op){
+
+                if (this->ref_map.count(page) == 0u){
+                    this->run_pending(page, op);
+                    return;
+                }
+
+                this->pending_map[page] |= op;
+                this->result.deferred_op += 1;
+            }
+
+            void release(size_t page){
+
+                this->backend.unmap(page);
+                auto it = this->ref_map.find(page);
+
+                if (--it->second != 0u){
+                    return;
+                }
+
+                this->ref_map.erase(it);
+
+                if (auto pending_it = this->pending_map.find(page); pending_it != this->pending_map.end()){
+                    uint8_t pending = pending_it->second;
+                    this->pending_map.erase(pending_it);
+                    this->run_pending(page, pending);
+                }
+            }
+
+            //the replay pages spanning the recorded page of offs
+            auto recorded_page_span(size_t offs) const noexcept -> std::pair<size_t, size_t>{
+
+                size_t first = offs / this->recorded_page_sz * this->recorded_page_sz;
+                return {first / this->page_sz, std::min((first + this->recorded_page_sz - 1) / this->page_sz + 1, this->virtual_page_count)};
+            }
+
+            void map(const TraceRecord& record){
+
+                size_t slot         = record.offs / this->recorded_page_sz;
+                size_t page_last    = (slot + 1) * this->recorded_page_sz;
+                size_t last_offs    = record.sz == 0u || record.sz >= this->recorded_page_sz ? record.offs + 1 : std::min(record.offs + record.sz, page_last);
+                size_t first_page   = record.offs / this->page_sz;
+                size_t last_page    = (last_offs - 1) / this->page_sz + 1;
+                bool is_write       = record.op == static_cast<uint8_t>(TraceOp::map);
+                size_t mapped_count = 0u;
+                size_t fill_count   = transfer_counter.fill_count.load();
+
+                double ns = this->charge([&]{
+                    for (size_t page = first_page; page != last_page && this->backend.map(page, is_write); ++page){
+                        mapped_count += 1;
+                    }
+                });
+
+                this->result.map_count += 1;
+                this->result.modeled_map_ns_list.push_back(ns);
+
+                if (mapped_count != last_page - first_page){
+                    for (size_t i = 0; i < mapped_count; ++i){
+                        this->backend.unmap(first_page + i);
+                    }
+
+                    this->result.no_page_found += 1;
+                    return;
+                }
+
+                if (transfer_counter.fill_count.load() == fill_count){
+                    this->result.hit_count += 1;
+                }
+
+                for (size_t page = first_page; page != last_page; ++page){
+                    this->ref_map[page] += 1;
+                    this->touched_set.insert(page);
+                }
+
+                this->mapping_map[slot].push_back(Mapping{record.thread_id, first_page, last_page});
+            }
+
+            void unmap(const TraceRecord& record){
+
+                auto it = this->mapping_map.find(record.offs / this->recorded_page_sz);
+
+                if (it == this->mapping_map.end()){
+                    this->result.unmatched_unmap += 1;
+                    return;
+                }
+
+                auto& mapping_list  = it->second;
+                auto mapping_it     = std::find_if(mapping_list.begin(), mapping_list.end(), [&](const Mapping& mapping){return mapping.thread_id == record.thread_id;}); //the unmapping thread's own mapping first
+                mapping_it          = mapping_it == mapping_list.end() ? mapping_list.begin() : mapping_it;
+                Mapping mapping     = *mapping_it;
+                mapping_list.erase(mapping_it);
+
+                if (mapping_list.empty()){
+                    this->mapping_map.erase(it);
+                }
+
+                for (size_t page = mapping.first_page; page != mapping.last_page; ++page){
+                    this->release(page);
+                }
+            }
+
+            void all(uint8_t op){
+
+                if (this->ref_map.empty()){
+                    this->charge([&]{
+                        if (op == PENDING_SHOOTDOWN){
+                            this->backend.flush();
+                        } else{
+                            this->backend.sync_all();
+                        }
+                    });
+
+                    return;
+                }
+
+                for (size_t page: this->touched_set){
+                    this->run_or_defer(page, op);
+                }
+            }
+
+        public:
+
+            Replayer(const Option& option, Backend& backend, const TraceHeader& header, size_t page_sz): option(option),
+                                                                                                        backend(backend),
+                                                                                                        recorded_page_sz(header.page_sz),
+                                                                                                        page_sz(page_sz),
+                                                                                                        virtual_page_count((header.translator_sz + page_sz - 1) / page_sz),
+                                                                                                        mapping_map(),
+                                                                                                        ref_map(),
+                                                                                                        pending_map(),
+                                                                                                        touched_set(),
+                                                                                                        result(){}
+
+            auto run(const std::vector<TraceRecord>& record_list) -> Result{
+
+                for (const TraceRecord& record: record_list){
+                    if (record.op != static_cast<uint8_t>(TraceOp::sync_all) && record.op != static_cast<uint8_t>(TraceOp::flush) && record.offs >= this->virtual_page_count * this->page_sz){
+                        continue; //corrupted
+                    }
+
+                    switch (static_cast<TraceOp>(record.op)){
+                        case TraceOp::map:
+                        case TraceOp::map_readonly:
+                            this->map(record);
+                            break;
+                        case TraceOp::unmap:
+                            this->unmap(record);
+                            break;
+                        case TraceOp::shootdown:
+                        case TraceOp::sync:
+                        {
+                            auto [first_page, last_page] = this->recorded_page_span(record.offs);
+                            uint8_t op = record.op == static_cast<uint8_t>(TraceOp::shootdown) ? PENDING_SHOOTDOWN : PENDING_SYNC;
+
+                            for (size_t page = first_page; page != last_page; ++page){
+                                this->run_or_defer(page, op);
+                            }
+
+                            break;
+                        }
+                        case TraceOp::sync_all:
+                            this->all(PENDING_SYNC);
+                            break;
+                        case TraceOp::flush:
+                            this->all(PENDING_SHOOTDOWN);
+                            break;
+                        default:
+                            break;
+                    }
+                }
+
+                while (!this->mapping_map.empty()){ //mapped at the end of the trace
+                    auto& mapping_list  = this->mapping_map.begin()->second;
+                    Mapping mapping     = mapping_list.front();
+                    mapping_list.pop_front();
+
+                    if (mapping_list.empty()){
+                        this->mapping_map.erase(this->mapping_map.begin());
+                    }
+
+                    for (size_t page = mapping.first_page; page != mapping.last_page; ++page){
+                        this->release(page);
+                    }
+                }
+
+                this->charge([&]{this->backend.flush();});
+
+                return std::move(this->result);
+            }
+    };
+
+    auto percentile(const std::vector<double>& sorted_list, double p) -> double{
+
+        if (sorted_list.empty()){
+            return 0.0;
+        }
+
+        return sorted_list[std::min(static_cast<size_t>(p * sorted_list.size()), sorted_list.size() - 1)];
+    }
+}
+
+int main(int argc, char ** argv){
+
+    using namespace replay;
+
+    Option option = parse_option(argc, argv);
+    TraceHeader header{};
+    std::vector<TraceRecord> record_list{};
+
+    if (!trace_read(option.trace_path, header, record_list)){
+        fprintf(stderr, "bad trace %s\n", option.trace_path.c_str());
+        return 1;
+    }
+
+    size_t page_sz                  = option.page_sz == 0u ? static_cast<size_t>(header.page_sz) : option.page_sz;
+    size_t virtual_page_count       = (header.translator_sz + page_sz - 1) / page_sz;
+    size_t physical_page_count      = option.physical_page_count == 0u ? std::max(static_cast<size_t>(header.translatee_sz / page_sz), size_t{1u}) : option.physical_page_count;
+    EvictionPolicy eviction_policy  = option.eviction_policy.value_or(static_cast<EvictionPolicy>(header.eviction_policy));
+
+    if (!option.eviction_policy && header.eviction_policy > static_cast<uint64_t>(EvictionPolicy::clock_cold_insert)){
+        fprintf(stderr, "unknown recorded eviction policy %zu - pass --policy\n", static_cast<size_t>(header.eviction_policy));
+        return 1;
+    }
+
+    if (page_sz < MIN_PAGE_SZ || (page_sz & (page_sz - 1)) != 0u){
+        fprintf(stderr, "page_sz must be a pow2 >= %zu\n", MIN_PAGE_SZ);
+        return 1;
+    }
+
+    std::unordered_set<uint16_t> thread_set{};
+
+    for (const TraceRecord& record: record_list){
+        thread_set.insert(record.thread_id);
+    }
+
+    Result result{};
+    std::optional<EngineConfig> config{};
+
+    if (option.mode == Mode::engine){
+        config = engine_config(option, header, page_sz, physical_page_count);
+        EngineBackend backend(*config, page_sz, virtual_page_count, physical_page_count, eviction_policy);
+        result = Replayer<EngineBackend>(option, backend, header, page_sz).run(record_list);
+    } else{
+        SimBackend backend(page_sz, physical_page_count, eviction_policy);
+        result = Replayer<SimBackend>(option, backend, header, page_sz).run(record_list);
+    }
+
+    std::sort(result.modeled_map_ns_list.begin(), result.modeled_map_ns_list.end());
+    double map_ns_sum   = 0.0;
+
+    for (double ns: result.modeled_map_ns_list){
+        map_ns_sum += ns;
+    }
+
+    double hit_rate     = result.map_count == 0u ? 0.0 : static_cast<double>(result.hit_count) / static_cast<double>(result.map_count);
+    double map_ns_mean  = result.map_count == 0u ? 0.0 : map_ns_sum / static_cast<double>(result.map_count);
+
+    printf("{\"mode\": \"%s\", \"policy\": \"%s\", \"page_sz\": %zu, \"recorded_page_sz\": %zu, \"virtual_pages\": %zu, \"physical_pages\": %zu, \"records\": %zu, \"threads\": %zu, ",
+           option.mode == Mode::engine ? "engine" : "sim", policy_name(eviction_policy), page_sz, static_cast<size_t>(header.page_sz), virtual_page_count, physical_page_count, record_list.size(), thread_set.size());
+    if (config){
+        printf("\"engine\": {\"thread_cache\": %s, \"dirty_chunk_sz\": %zu, \"readahead_pages\": %zu, \"layout\": \"%s\", \"victim_tier_sz\": %zu, \"recorded_victim_tier_sz\": %zu, \"numa_nodes\": %zu}, ",
+               config->thread_cache_enabled ? "true" : "false", config->dirty_chunk_sz, config->readahead_page_count, layout_name(config->page_table_layout), config->victim_tier_sz, static_cast<size_t>(header.victim_tier_sz), config->numa_node_count);
+    } else{
+        printf("\"engine\": null, ");
+    }
+
+    printf("\"maps\": %zu, \"hits\": %zu, \"hit_rate\": %.6f, \"no_page_found\": %zu, \"unmatched_unmap\": %zu, \"deferred_op\": %zu, ",
+           result.map_count, result.hit_count, hit_rate, result.no_page_found, result.unmatched_unmap, result.deferred_op);
+    printf("\"fill_count\": %zu, \"fill_byte\": %zu, \"write_back_count\": %zu, \"write_back_byte\": %zu, ",
+           transfer_counter.fill_count.load(), transfer_counter.fill_byte.load(), transfer_counter.write_back_count.load(), transfer_counter.write_back_byte.load());
+    printf("\"modeled_ns\": %.0f, \"modeled_map_ns_mean\": %.1f, \"modeled_map_ns_p50\": %.1f, \"modeled_map_ns_p99\": %.1f, \"modeled_map_ns_p999\": %.1f}\n",
+           result.modeled_ns, map_ns_mean, percentile(result.modeled_map_ns_list, 0.5), percentile(result.modeled_map_ns_list, 0.99), percentile(result.modeled_map_ns_list, 0.999));
+
+    return 0;
+}
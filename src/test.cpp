@@ -1,5 +1,1672 @@
+//behavioural checks of dg_tlb.h - host memory, memcpy transfer devices. exits non-zero if any check fails
+//g++ -std=c++17 -O2 -pthread test.cpp -o test && ./test (add -D__DG_TLB_STATS__ for the counter checks, -std=c++20 for the coroutine checks)
+
 #include "dg_tlb.h"
+#include "dg_tlb_file.h"
+#include "dg_tlb_numa.h"
+#include "dg_tlb_trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <new>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace test{
+
+    using namespace dg::flush_on_cap_tlb;
+
+    static inline constexpr size_t TEST_PAGE_SZ = size_t{1} << 12;
+
+    static inline const char * test_name    = "";
+    static inline size_t failure_count      = 0u;
+
+    void expect(bool cond, const char * what){
+
+        if (!cond){
+            fprintf(stderr, "FAIL %s: %s\n", test_name, what);
+            failure_count += 1;
+        }
+    }
+
+    struct DeviceCounter{
+        std::atomic<size_t> fill_count{};
+        std::atomic<size_t> fill_byte{};
+        std::atomic<size_t> write_back_count{};
+        std::atomic<size_t> write_back_byte{};
+
+        void reset() noexcept{
+
+            fill_count          = 0u;
+            fill_byte           = 0u;
+            write_back_count    = 0u;
+            write_back_byte     = 0u;
+        }
+    };
+
+    static inline DeviceCounter device_counter{};
+
+    void fill_device(void * dst, const void * src, size_t sz) noexcept{
+
+        memcpy(dst, src, sz);
+        device_counter.fill_count.fetch_add(1u, std::memory_order_relaxed);
+        device_counter.fill_byte.fetch_add(sz, std::memory_order_relaxed);
+    }
+
+    void write_back_device(void * dst, const void * src, size_t sz) noexcept{
+
+        memcpy(dst, src, sz);
+        device_counter.write_back_count.fetch_add(1u, std::memory_order_relaxed);
+        device_counter.write_back_byte.fetch_add(sz, std::memory_order_relaxed);
+    }
+
+    static inline std::atomic<size_t> transfer_delay_ms{}; //slow_fill_device + slow_write_back_device sleep this long per transfer
+
+    void slow_fill_device(void * dst, const void * src, size_t sz) noexcept{
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(transfer_delay_ms.load()));
+        fill_device(dst, src, sz);
+    }
+
+    void slow_write_back_device(void * dst, const void * src, size_t sz) noexcept{
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(transfer_delay_ms.load()));
+        write_back_device(dst, src, sz);
+    }
+
+    //translator + translatee of page_sz aligned host memory. the translator starts as pattern(i) at byte i
+    class Arena{
+
+        private:
+
+            char * translator_addr;
+            char * translatee_addr;
+            size_t translator_byte_sz;
+            size_t translatee_byte_sz;
+
+        public:
+
+            Arena(size_t virtual_page_count, size_t physical_page_count, size_t page_sz = TEST_PAGE_SZ): translator_addr(static_cast<char *>(aligned_alloc(page_sz, virtual_page_count * page_sz))),
+                                                                                                         translatee_addr(static_cast<char *>(aligned_alloc(page_sz, physical_page_count * page_sz))),
+                                                                                                         translator_byte_sz(virtual_page_count * page_sz),
+                                                                                                         translatee_byte_sz(physical_page_count * page_sz){
+
+                for (size_t i = 0; i < this->translator_byte_sz; ++i){
+                    this->translator_addr[i] = pattern(i);
+                }
+
+                memset(this->translatee_addr, 0, this->translatee_byte_sz);
+                device_counter.reset();
+            }
+
+            Arena(const Arena&) = delete;
+            Arena& operator =(const Arena&) = delete;
+
+            ~Arena() noexcept{
+
+                free(this->translator_addr);
+                free(this->translatee_addr);
+            }
+
+            static auto pattern(size_t i) noexcept -> char{
+
+                return static_cast<char>((i * 131u) ^ (i >> 12));
+            }
+
+            auto translator() const noexcept -> char *{
+
+                return this->translator_addr;
+            }
+
+            auto translator_sz() const noexcept -> size_t{
+
+                return this->translator_byte_sz;
+            }
+
+            auto translatee() const noexcept -> char *{
+
+                return this->translatee_addr;
+            }
+
+            auto translatee_sz() const noexcept -> size_t{
+
+                return this->translatee_byte_sz;
+            }
+    };
+
+    //the arena with the memcpy transfer devices at TEST_PAGE_SZ - tests set the other fields by name
+    auto arena_config(const Arena& arena, EvictionPolicy eviction_policy = EvictionPolicy::clock) -> Config{
+
+        Config config{};
+        config.translator_addr                      = arena.translator();
+        config.translator_sz                        = arena.translator_sz();
+        config.translatee_addr                      = arena.translatee();
+        config.translatee_sz                        = arena.translatee_sz();
+        config.virtual_to_physical_transfer_device  = fill_device;
+        config.physical_to_virtual_transfer_device  = write_back_device;
+        config.eviction_policy                      = eviction_policy;
+        config.page_sz                              = TEST_PAGE_SZ;
+
+        return config;
+    }
+
+    static inline constexpr EvictionPolicy EVICTION_POLICY_LIST[] = {EvictionPolicy::flush_zero_ref, EvictionPolicy::clock, EvictionPolicy::clock_cold_insert};
+
+    //every page is rewritten in random order through a pool of an eighth of the pages, the translator holds the last writes after flush
+    void test_eviction_round_trip(){
+
+        for (EvictionPolicy eviction_policy: EVICTION_POLICY_LIST){
+            Arena arena(64u, 8u);
+            TLB tlb(arena_config(arena, eviction_policy));
+            std::vector<uint32_t> expected(64u, 0u);
+            std::mt19937_64 rng(7u);
+            bool is_intact = true;
+
+            for (size_t i = 0; i < 4096u; ++i){
+                size_t page     = rng() % 64u;
+                char * ptr      = arena.translator() + page * TEST_PAGE_SZ;
+                auto * mapped   = static_cast<char *>(tlb.map(ptr));
+
+                uint32_t first_word{};
+                memcpy(&first_word, mapped, sizeof(uint32_t));
+                is_intact       = is_intact && (expected[page] == 0u || first_word == expected[page]); //a refetched page holds the last write
+
+                expected[page]  = static_cast<uint32_t>(i + 1);
+                memcpy(mapped, &expected[page], sizeof(uint32_t));
+                tlb.unmap(ptr);
+            }
+
+            tlb.flush();
+            expect(is_intact, "a refetched page lost its last write");
+
+            for (size_t page = 0; page < 64u; ++page){
+                uint32_t word{};
+                memcpy(&word, arena.translator() + page * TEST_PAGE_SZ, sizeof(uint32_t));
+                expect(expected[page] == 0u || word == expected[page], "flush did not write the last value back");
+                expect(arena.translator()[page * TEST_PAGE_SZ + 64u] == Arena::pattern(page * TEST_PAGE_SZ + 64u), "an unwritten byte changed");
+            }
+
+            expect(device_counter.fill_count > 8u, "the pool never evicted");
+        }
+    }
+
+    //a pool with every page pinned throws no_page_found, unpinning one page makes the next map succeed
+    void test_no_page_found(){
+
+        for (EvictionPolicy eviction_policy: EVICTION_POLICY_LIST){
+            Arena arena(16u, 4u);
+            TLB tlb(arena_config(arena, eviction_policy));
+
+            for (size_t page = 0; page < 4u; ++page){
+                tlb.map(arena.translator() + page * TEST_PAGE_SZ);
+            }
+
+            bool is_thrown = false;
+
+            try{
+                tlb.map(arena.translator() + 4u * TEST_PAGE_SZ);
+            } catch (no_page_found&){
+                is_thrown = true;
+            }
+
+            expect(is_thrown, "a fully pinned pool mapped another page");
+            tlb.unmap(arena.translator());
+            expect(tlb.map(arena.translator() + 4u * TEST_PAGE_SZ) != nullptr, "an unpinned page was not reused");
+
+            for (size_t page = 1; page < 5u; ++page){
+                tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+            }
+        }
+    }
+
+    //the pool hands out every physical page exactly once while all are pinned
+    void test_free_list_distinct(){
+
+        Arena arena(64u, 48u);
+        TLB tlb(arena_config(arena));
+        std::vector<char *> mapped_list{};
+
+        for (size_t page = 0; page < 48u; ++page){
+            mapped_list.push_back(static_cast<char *>(tlb.map(arena.translator() + page * TEST_PAGE_SZ)));
+        }
+
+        std::vector<char *> sorted_list = mapped_list;
+        std::sort(sorted_list.begin(), sorted_list.end());
+
+        expect(std::adjacent_find(sorted_list.begin(), sorted_list.end()) == sorted_list.end(), "a physical page was handed out twice");
+        expect(sorted_list.front() >= arena.translatee() && sorted_list.back() < arena.translatee() + arena.translatee_sz(), "a mapped addr lies outside of the translatee");
+
+        for (size_t page = 0; page < 48u; ++page){
+            expect(memcmp(mapped_list[page], arena.translator() + page * TEST_PAGE_SZ, TEST_PAGE_SZ) == 0, "a filled page differs from the translator");
+            tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+        }
+    }
+
+    //threads map/write/unmap random pages through a small pool while thread 0 shoots pages down - every increment survives
+    //thread t only writes the word t of a page, so the expected translator content is exact
+    void test_map_unmap_shootdown_stress(){
+
+        constexpr size_t THREAD_COUNT   = 8u;
+        constexpr size_t PAGE_COUNT     = 64u;
+        constexpr size_t OP_COUNT       = 20000u;
+
+        for (EvictionPolicy eviction_policy: EVICTION_POLICY_LIST){
+            for (bool thread_cache_enabled: {false, true}){
+                Arena arena(PAGE_COUNT, 16u);
+                memset(arena.translator(), 0, arena.translator_sz());
+                Config config               = arena_config(arena, eviction_policy);
+                config.thread_cache_enabled = thread_cache_enabled;
+                TLB tlb(config);
+                std::vector<std::vector<uint64_t>> expected(THREAD_COUNT, std::vector<uint64_t>(PAGE_COUNT, 0u));
+                std::atomic<size_t> no_page_found_count{};
+                std::vector<std::thread> thread_list{};
+
+                for (size_t t = 0; t < THREAD_COUNT; ++t){
+                    thread_list.emplace_back([&, t]{
+                        std::mt19937_64 rng(t + 1u);
+
+                        for (size_t i = 0; i < OP_COUNT; ++i){
+                            size_t page = rng() % PAGE_COUNT;
+                            char * ptr  = arena.translator() + page * TEST_PAGE_SZ + t * sizeof(uint64_t);
+
+                            if (t == 0u && i % 64u == 63u){
+                                tlb.shootdown(arena.translator() + (rng() % PAGE_COUNT) * TEST_PAGE_SZ);
+                                continue;
+                            }
+
+                            try{
+                                auto * word = static_cast<uint64_t *>(tlb.map(ptr));
+                                *word += 1u;
+                                expected[t][page] += 1u;
+                                tlb.unmap(ptr);
+                            } catch (no_page_found&){
+                                no_page_found_count += 1;
+                            }
+                        }
+                    });
+                }
+
+                for (auto& thread: thread_list){
+                    thread.join();
+                }
+
+                tlb.flush();
+                bool is_intact = true;
+
+                for (size_t t = 0; t < THREAD_COUNT; ++t){
+                    for (size_t page = 0; page < PAGE_COUNT; ++page){
+                        uint64_t word{};
+                        memcpy(&word, arena.translator() + page * TEST_PAGE_SZ + t * sizeof(uint64_t), sizeof(uint64_t));
+                        is_intact = is_intact && word == expected[t][page];
+                    }
+                }
+
+                expect(is_intact, "an increment was lost");
+                expect(no_page_found_count == 0u, "a pool of twice the thread count ran out of pages");
+            }
+        }
+    }
+
+    //a re-map is served from the thread cache, idle cached references give way to shootdown, eviction and thread exit
+    void test_thread_cache(){
+
+        Arena arena(16u, 4u);
+        Config config               = arena_config(arena);
+        config.thread_cache_enabled = true;
+        TLB tlb(config);
+        char * ptr      = arena.translator();
+        void * first    = tlb.map(ptr);
+        tlb.unmap(ptr);
+
+        for (size_t i = 0; i < 16u; ++i){
+            expect(tlb.map(ptr) == first, "a cached re-map moved the page");
+            tlb.unmap(ptr);
+        }
+
+        expect(device_counter.fill_count == 1u, "a cached re-map refilled the page");
+
+        #if defined(__DG_TLB_STATS__)
+        expect(tlb.stats().get(Stat::thread_cache_hit) == 16u, "cached re-maps were not counted as thread_cache_hit");
+        #endif
+
+        tlb.shootdown(ptr); //revokes the idle cached reference
+        ptr[0] = 'x';
+        expect(static_cast<char *>(tlb.map(ptr))[0] == 'x', "a shot down page was served from the thread cache");
+        tlb.unmap(ptr);
+
+        for (size_t i = 0; i < 64u; ++i){ //every page stays cached after unmap - a pool of 4 must still cycle 16 pages
+            char * page_ptr = arena.translator() + (i % 16u) * TEST_PAGE_SZ;
+            static_cast<char *>(tlb.map(page_ptr))[1] = static_cast<char>(i);
+            tlb.unmap(page_ptr);
+        }
+
+        std::thread([&]{
+            for (size_t page = 4u; page < 8u; ++page){
+                tlb.map(arena.translator() + page * TEST_PAGE_SZ);
+                tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+            }
+        }).join();
+
+        for (size_t page = 8u; page < 12u; ++page){ //the exited thread's cached references are gone
+            tlb.map(arena.translator() + page * TEST_PAGE_SZ);
+        }
+
+        for (size_t page = 8u; page < 12u; ++page){
+            tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+        }
+
+        tlb.flush();
+
+        for (size_t i = 48u; i < 64u; ++i){
+            expect(arena.translator()[(i % 16u) * TEST_PAGE_SZ + 1u] == static_cast<char>(i), "a cached write was lost");
+        }
+    }
+
+    //instances share no state - concurrent use, move-assignment and destruction flush only their own pages
+    void test_independent_instance(){
+
+        Arena arena_a(16u, 4u);
+        Arena arena_b(16u, 4u);
+        Config config_a               = arena_config(arena_a);
+        config_a.thread_cache_enabled = true;
+        TLB tlb_a(config_a);
+        Config config_b               = arena_config(arena_b);
+        config_b.thread_cache_enabled = true;
+        TLB tlb_b(config_b);
+
+        auto write_every_page = [](TLB& tlb, Arena& arena, char val){
+            for (size_t i = 0; i < 256u; ++i){
+                char * ptr = arena.translator() + (i % 16u) * TEST_PAGE_SZ;
+                static_cast<char *>(tlb.map(ptr))[0] = val;
+                tlb.unmap(ptr);
+            }
+        };
+
+        std::thread thread_a([&]{write_every_page(tlb_a, arena_a, 'a');});
+        std::thread thread_b([&]{write_every_page(tlb_b, arena_b, 'b');});
+        thread_a.join();
+        thread_b.join();
+
+        static_cast<char *>(tlb_a.map(arena_a.translator() + TEST_PAGE_SZ))[0] = 'A'; //still dirty in the pool at the move
+        tlb_a.unmap(arena_a.translator() + TEST_PAGE_SZ);
+        tlb_a = std::move(tlb_b); //tears the old table of tlb_a down
+
+        expect(arena_a.translator()[TEST_PAGE_SZ] == 'A', "move-assignment did not flush the replaced instance");
+        static_cast<char *>(tlb_a.map(arena_b.translator()))[0] = 'B';
+        tlb_a.unmap(arena_b.translator());
+
+        {
+            TLB moved(std::move(tlb_a));
+        }
+
+        expect(arena_b.translator()[0] == 'B', "destruction did not flush the moved-to instance");
+
+        for (size_t page = 1; page < 16u; ++page){
+            expect(arena_a.translator()[page * TEST_PAGE_SZ] == (page == 1u ? 'A' : 'a'), "a write through instance a was lost");
+            expect(arena_b.translator()[page * TEST_PAGE_SZ] == 'b', "a write through instance b was lost");
+        }
+    }
+
+    //read-only pages are evicted and synced without a write back, a sync leaves a written page clean
+    void test_clean_page_no_write_back(){
+
+        for (EvictionPolicy eviction_policy: EVICTION_POLICY_LIST){
+            Arena arena(32u, 4u);
+            TLB tlb(arena_config(arena, eviction_policy));
+            bool is_intact = true;
+
+            for (size_t i = 0; i < 256u; ++i){
+                size_t page     = (i * 7u) % 32u;
+                char * ptr      = arena.translator() + page * TEST_PAGE_SZ + 3u;
+                is_intact       = is_intact && *static_cast<char *>(tlb.map_readonly(ptr)) == Arena::pattern(page * TEST_PAGE_SZ + 3u);
+                tlb.unmap(ptr);
+            }
+
+            tlb.sync();
+            expect(is_intact, "a read-only map saw the wrong content");
+            expect(device_counter.fill_count > 4u, "the pool never evicted");
+            expect(device_counter.write_back_count == 0u, "a clean page was written back");
+
+            static_cast<char *>(tlb.map(arena.translator()))[0] = 'w';
+            tlb.unmap(arena.translator());
+            tlb.sync();
+            expect(device_counter.write_back_count == 1u && arena.translator()[0] == 'w', "a written page was not synced");
+
+            tlb.sync();
+            tlb.map_readonly(arena.translator());
+            tlb.unmap(arena.translator());
+            tlb.flush();
+            expect(device_counter.write_back_count == 1u, "a synced page was written back again");
+        }
+    }
+
+    //map() dirties the whole page whatever the offset of ptr, map_write() only the chunks spanning its range
+    void test_partial_dirty_write_back(){
+
+        Arena arena(16u, 4u);
+        Config config         = arena_config(arena);
+        config.dirty_chunk_sz = 512u;
+        TLB tlb(config);
+        char * ptr      = arena.translator() + TEST_PAGE_SZ / 2u;
+        char * mapped   = static_cast<char *>(tlb.map(ptr));
+        mapped[-static_cast<ptrdiff_t>(TEST_PAGE_SZ / 2u)]        = 'a'; //below ptr
+        mapped[-static_cast<ptrdiff_t>(TEST_PAGE_SZ / 2u) + 100]  = 'b';
+        mapped[0]                                                 = 'c';
+        tlb.unmap(ptr);
+        tlb.flush();
+
+        expect(arena.translator()[0] == 'a' && arena.translator()[100] == 'b' && arena.translator()[TEST_PAGE_SZ / 2u] == 'c', "a write through map() below ptr was lost");
+        expect(device_counter.write_back_byte == TEST_PAGE_SZ, "map() did not write the whole page back");
+
+        device_counter.reset();
+        ptr             = arena.translator() + TEST_PAGE_SZ + 1020u;
+        mapped          = static_cast<char *>(tlb.map_write(ptr, 20u)); //chunk [512, 1024) + [1024, 1536)
+        memset(mapped, 'd', 20u);
+        tlb.unmap(ptr);
+        tlb.flush();
+
+        expect(memcmp(arena.translator() + TEST_PAGE_SZ + 1020u, "dddddddddddddddddddd", 20u) == 0, "a map_write() range was lost");
+        expect(device_counter.write_back_byte == 1024u, "map_write() wrote back more than the chunks of its range");
+        expect(arena.translator()[TEST_PAGE_SZ + 1536u] == Arena::pattern(TEST_PAGE_SZ + 1536u), "an unwritten chunk changed");
+    }
+
+    //fills + write backs through thread pool async devices keep every write, a flush writes each dirty page back once
+    void test_async_transfer_device(){
+
+        for (EvictionPolicy eviction_policy: EVICTION_POLICY_LIST){
+            Arena arena(64u, 16u);
+            memset(arena.translator(), 0, arena.translator_sz());
+            ThreadPoolTransferDevice fill_pool(fill_device, 4u);
+            ThreadPoolTransferDevice write_back_pool(write_back_device, 4u);
+            Config config                                    = arena_config(arena, eviction_policy);
+            config.virtual_to_physical_async_transfer_device = fill_pool.get();
+            config.physical_to_virtual_async_transfer_device = write_back_pool.get();
+            TLB tlb(config);
+            std::vector<std::thread> thread_list{};
+
+            for (size_t t = 0; t < 4u; ++t){
+                thread_list.emplace_back([&, t]{
+                    for (size_t i = 0; i < 2048u; ++i){
+                        char * ptr = arena.translator() + ((i * 13u + t) % 64u) * TEST_PAGE_SZ + t * sizeof(uint32_t);
+                        *static_cast<uint32_t *>(tlb.map(ptr)) += 1u;
+                        tlb.unmap(ptr);
+                    }
+                });
+            }
+
+            for (auto& thread: thread_list){
+                thread.join();
+            }
+
+            tlb.flush();
+            bool is_intact = true;
+
+            for (size_t t = 0; t < 4u; ++t){
+                for (size_t page = 0; page < 64u; ++page){
+                    uint32_t word{};
+                    memcpy(&word, arena.translator() + page * TEST_PAGE_SZ + t * sizeof(uint32_t), sizeof(uint32_t));
+                    is_intact = is_intact && word == 2048u / 64u;
+                }
+            }
+
+            expect(is_intact, "a write through the async devices was lost");
+
+            device_counter.reset();
+
+            for (size_t page = 0; page < 16u; ++page){
+                tlb.map(arena.translator() + page * TEST_PAGE_SZ);
+                tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+            }
+
+            tlb.flush();
+            expect(device_counter.write_back_byte == 16u * TEST_PAGE_SZ, "a batched flush did not write each dirty page back once"); //the pool may split a page into several jobs
+        }
+    }
+
+    //prefetched pages and the pages read ahead of a sequential miss pattern are mapped without another fill
+    void test_prefetch_readahead(){
+
+        {
+            Arena arena(32u, 16u);
+            TLB tlb(arena_config(arena));
+            tlb.prefetch(arena.translator() + 8u * TEST_PAGE_SZ + 1u, 4u * TEST_PAGE_SZ - 1u); //runs inline without an executor
+            expect(device_counter.fill_count == 4u, "prefetch did not link the pages of its range");
+
+            for (size_t page = 8u; page < 12u; ++page){
+                expect(*static_cast<char *>(tlb.map(arena.translator() + page * TEST_PAGE_SZ)) == Arena::pattern(page * TEST_PAGE_SZ), "a prefetched page holds the wrong content");
+                tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+            }
+
+            expect(device_counter.fill_count == 4u, "a prefetched page was filled again on map");
+        }
+
+        {
+            Arena arena(32u, 16u);
+            Config config               = arena_config(arena);
+            config.readahead_page_count = 4u;
+            TLB tlb(config);
+
+            for (size_t page = 0; page < 3u; ++page){ //the third miss repeats the stride - pages 3 .. 6 are read ahead, inline without an executor
+                tlb.map(arena.translator() + page * TEST_PAGE_SZ);
+                tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+            }
+
+            expect(device_counter.fill_count == 7u, "the pages after a sequential miss pattern were not read ahead");
+
+            for (size_t page = 3u; page < 7u; ++page){
+                expect(*static_cast<char *>(tlb.map(arena.translator() + page * TEST_PAGE_SZ)) == Arena::pattern(page * TEST_PAGE_SZ), "a read ahead page holds the wrong content");
+                tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+            }
+
+            expect(device_counter.fill_count == 7u, "a read ahead page was filled again on map");
+        }
+
+        {
+            Arena arena(32u, 16u);
+            ThreadPoolExecutor executor(2u);
+            Config config               = arena_config(arena);
+            config.readahead_page_count = 4u;
+            config.prefetch_executor    = executor.get();
+            TLB tlb(config);
+
+            for (size_t page = 0; page < 32u; ++page){ //maps race the background readahead
+                expect(*static_cast<char *>(tlb.map(arena.translator() + page * TEST_PAGE_SZ)) == Arena::pattern(page * TEST_PAGE_SZ), "a page read ahead in the background holds the wrong content");
+                tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+            }
+        }
+    }
+
+    //the page size is per instance - small and large pages round trip, remap stays in place within a page and moves across pages
+    void test_page_size(){
+
+        for (size_t page_sz: {size_t{256u}, size_t{1} << 16}){
+            Arena arena(64u, 8u, page_sz);
+            Config config  = arena_config(arena);
+            config.page_sz = page_sz;
+            TLB tlb(config);
+
+            for (size_t i = 0; i < 512u; ++i){
+                char * ptr = arena.translator() + ((i * 5u) % 64u) * page_sz + page_sz - 1u;
+                static_cast<char *>(tlb.map(ptr))[0] = static_cast<char>(i);
+                tlb.unmap(ptr);
+            }
+
+            char * ptr      = arena.translator() + page_sz;
+            char * mapped   = static_cast<char *>(tlb.map(ptr));
+            char * in_page  = static_cast<char *>(tlb.remap(ptr, mapped, ptr + page_sz - 1u));
+            expect(in_page == mapped + page_sz - 1u, "a remap within the page moved the mapping");
+
+            char * next     = static_cast<char *>(tlb.remap(ptr, mapped, ptr + page_sz));
+            expect(*next == Arena::pattern(2u * page_sz), "a remap across pages mapped the wrong page");
+            tlb.unmap(ptr + page_sz);
+            tlb.flush();
+
+            for (size_t i = 448u; i < 512u; ++i){
+                expect(arena.translator()[((i * 5u) % 64u) * page_sz + page_sz - 1u] == static_cast<char>(i), "a write at the last byte of a page was lost");
+            }
+
+            expect(device_counter.fill_byte == device_counter.fill_count * page_sz, "a fill did not transfer one page");
+        }
+    }
+
+    //counters match the operations (zero without __DG_TLB_STATS__), the counters of exited threads are kept
+    void test_stats(){
+
+        Arena arena(8u, 4u);
+        TLB tlb(arena_config(arena));
+
+        std::thread([&]{
+            for (size_t page = 0; page < 4u; ++page){
+                tlb.map(arena.translator() + page * TEST_PAGE_SZ);
+            }
+        }).join();
+
+        tlb.map(arena.translator()); //hit
+
+        bool is_thrown = false;
+
+        try{
+            tlb.map(arena.translator() + 4u * TEST_PAGE_SZ);
+        } catch (no_page_found&){
+            is_thrown = true;
+        }
+
+        for (size_t page = 0; page < 4u; ++page){
+            tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+        }
+
+        tlb.unmap(arena.translator());
+        tlb.map_readonly(arena.translator() + 4u * TEST_PAGE_SZ); //evicts one written page
+        tlb.unmap(arena.translator() + 4u * TEST_PAGE_SZ);
+
+        Stats stats     = tlb.stats();
+        size_t total    = 0u;
+
+        for (size_t count: stats.miss_latency_histogram){
+            total += count;
+        }
+
+        expect(is_thrown, "a fully pinned pool mapped another page");
+
+        #if defined(__DG_TLB_STATS__)
+        expect(stats.get(Stat::map_miss) == 5u, "map_miss differs from the linked pages");
+        expect(stats.get(Stat::map_hit) == 1u, "map_hit differs from the re-maps");
+        expect(stats.get(Stat::no_page_found) == 1u, "no_page_found was not counted");
+        expect(stats.get(Stat::clock_evict) == 1u, "clock_evict differs from the evictions");
+        expect(stats.get(Stat::fill_transfer) == 5u && stats.get(Stat::fill_byte) == 5u * TEST_PAGE_SZ, "fill counters differ from the device");
+        expect(stats.get(Stat::write_back_transfer) == 1u && stats.get(Stat::write_back_byte) == TEST_PAGE_SZ, "write back counters differ from the device");
+        expect(total == 5u, "the miss latency histogram differs from the misses");
+        #else
+        for (size_t i = 0; i < STAT_COUNT; ++i){
+            expect(stats.counter_list[i] == 0u, "a counter is non-zero without __DG_TLB_STATS__");
+        }
+
+        expect(total == 0u, "the miss latency histogram is non-zero without __DG_TLB_STATS__");
+        #endif
+    }
+
+    //threads that hit pages in transfer behind slow fills + write backs wait (spin, then park) and all see the right content
+    void test_slow_transfer_wait(){
+
+        Arena arena(8u, 4u);
+        Config config                              = arena_config(arena);
+        config.virtual_to_physical_transfer_device = slow_fill_device;
+        config.physical_to_virtual_transfer_device = slow_write_back_device;
+        TLB tlb(config);
+        transfer_delay_ms = 20u;
+        std::vector<std::thread> thread_list{};
+        std::atomic<size_t> mismatch_count{};
+
+        for (size_t t = 0; t < 16u; ++t){
+            thread_list.emplace_back([&, t]{
+                for (size_t i = 0; i < 4u; ++i){
+                    size_t page = (t + i) % 8u;
+                    char * ptr  = arena.translator() + page * TEST_PAGE_SZ + 16u + t;
+
+                    try{
+                        char * mapped = static_cast<char *>(tlb.map(ptr));
+
+                        if (*mapped != Arena::pattern(page * TEST_PAGE_SZ + 16u + t) && *mapped != 'w'){
+                            mismatch_count += 1;
+                        }
+
+                        *mapped = 'w';
+                        tlb.unmap(ptr);
+                    } catch (no_page_found&){} //16 threads over a pool of 4
+                }
+            });
+        }
+
+        for (auto& thread: thread_list){
+            thread.join();
+        }
+
+        transfer_delay_ms = 0u;
+        tlb.flush();
+        expect(mismatch_count == 0u, "a waiter saw a page before its transfer completed");
+    }
+
+    //a page holds up to VIRTUAL_PAGE_MAX_REF references - one more throws reference_overflow and leaves the page as is
+    void test_reference_overflow(){
+
+        constexpr size_t BATCH_SZ                   = size_t{1} << 16;
+        constexpr virtual_page_state_t FULL_STATE   = virtual_page_make((size_t{1} << (sizeof(virtual_page_state_t) * CHAR_BIT - REF_BITCOUNT - FLAG_BITCOUNT)) - 2u, VIRTUAL_PAGE_MAX_REF, virtual_page_dirty_flag);
+
+        expect(!virtual_page_is_transfer(FULL_STATE) && FULL_STATE != virtual_page_null_state, "a full page state reads as null or transfer");
+        expect(virtual_page_extract_counter(FULL_STATE) == VIRTUAL_PAGE_MAX_REF && virtual_page_extract_flags(FULL_STATE) == virtual_page_dirty_flag, "a full counter spilled into the flags");
+
+        Arena arena(4u, 2u);
+        TLB tlb(arena_config(arena));
+        std::vector<const void *> in(BATCH_SZ, arena.translator());
+        std::vector<void *> out(BATCH_SZ);
+        size_t ref_count = 0u;
+
+        while (ref_count != VIRTUAL_PAGE_MAX_REF){ //a run of one pointer takes its references with one cmpexch
+            size_t sz = std::min(BATCH_SZ, VIRTUAL_PAGE_MAX_REF - ref_count);
+            tlb.map_batch(in.data(), out.data(), sz);
+            ref_count += sz;
+        }
+
+        bool is_map_thrown      = false;
+        bool is_batch_thrown    = false;
+
+        try{
+            tlb.map(arena.translator());
+        } catch (reference_overflow&){
+            is_map_thrown = true;
+        }
+
+        try{
+            tlb.map_batch(in.data(), out.data(), 2u);
+        } catch (reference_overflow&){
+            is_batch_thrown = true;
+        }
+
+        expect(is_map_thrown && is_batch_thrown, "a page with VIRTUAL_PAGE_MAX_REF references took another one");
+        tlb.unmap(arena.translator());
+        expect(tlb.map(arena.translator()) == out[0], "a released reference could not be taken again");
+
+        while (ref_count != 0u){
+            size_t sz = std::min(BATCH_SZ, ref_count);
+            tlb.unmap_batch(in.data(), sz);
+            ref_count -= sz;
+        }
+
+        tlb.flush(); //waits for every reference - returns only if the count is back to zero
+    }
+
+    //an unmap of a linked page without a reference aborts - the counter would wrap into the flags + idx
+    void test_unbalanced_unmap(){
+
+        Arena arena(4u, 2u);
+        TLB tlb(arena_config(arena));
+        tlb.map(arena.translator());
+        tlb.unmap(arena.translator()); //linked, zero ref
+
+        pid_t pid = fork();
+
+        if (pid == 0){
+            tlb.unmap(arena.translator());
+            _exit(0);
+        }
+
+        int status = 0;
+        expect(pid > 0 && waitpid(pid, &status, 0) == pid, "the unbalanced unmap child could not be run");
+        expect(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT, "an unbalanced unmap did not abort");
+        expect(tlb.map(arena.translator()) != nullptr, "the page of the parent was changed by the child");
+        tlb.unmap(arena.translator());
+    }
+
+    //a PageRef pins until destroyed, a MappedRange coalesces physically adjacent pages into one span
+    void test_page_ref_mapped_range(){
+
+        Arena arena(16u, 128u);
+        TLB tlb(arena_config(arena));
+
+        {
+            PageRef page_ref = tlb.map_ref(arena.translator() + 8u);
+            PageRef moved    = std::move(page_ref);
+            expect(!page_ref && moved && static_cast<char *>(moved.get())[0] == Arena::pattern(8u), "a moved PageRef lost its mapping");
+            static_cast<char *>(moved.get())[0] = 'r';
+        }
+
+        tlb.flush(); //waits for the reference of the PageRef
+        expect(arena.translator()[8] == 'r', "a write through a PageRef was lost");
+
+        {
+            MappedRange range = tlb.map_range(arena.translator() + 100u, 3u * TEST_PAGE_SZ); //4 pages, linked together from one free list
+            expect(range.spans().size() == 1u && range.contiguous() != nullptr, "adjacent physical pages were not coalesced");
+            expect(range.spans().front().sz == 3u * TEST_PAGE_SZ, "the span does not cover the range");
+            memset(range.contiguous(), 'm', 3u * TEST_PAGE_SZ);
+        }
+
+        tlb.flush();
+        expect(arena.translator()[99] == Arena::pattern(99u) && arena.translator()[100] == 'm' && arena.translator()[3u * TEST_PAGE_SZ + 99u] == 'm' && arena.translator()[3u * TEST_PAGE_SZ + 100u] == Arena::pattern(3u * TEST_PAGE_SZ + 100u), "a contiguous range write was lost or spilled");
+
+        //tlb holds no page after the flush - an instance over the same arena starts from full free lists
+        TLB fresh_tlb(arena_config(arena));
+        PageRef middle      = fresh_tlb.map_ref(arena.translator() + 9u * TEST_PAGE_SZ); //linked ahead of the range - takes the physical page between the pages of 8 and 10
+        MappedRange range   = fresh_tlb.map_range_readonly(arena.translator() + 8u * TEST_PAGE_SZ, 3u * TEST_PAGE_SZ);
+        size_t byte_sz      = 0u;
+
+        for (const MappedSpan& span: range.spans()){
+            byte_sz += span.sz;
+        }
+
+        expect(range.spans().size() == 3u && range.contiguous() == nullptr, "non-adjacent physical pages were coalesced");
+        expect(byte_sz == 3u * TEST_PAGE_SZ && range.spans()[1].addr == middle.get(), "the spans do not cover the range in translator order");
+        expect(static_cast<char *>(range.spans()[2].addr)[0] == Arena::pattern(10u * TEST_PAGE_SZ), "a span maps the wrong page");
+    }
+
+    //map_batch maps duplicates, nulls and offsets like n map()s, a batch that does not fit the pool maps nothing
+    void test_map_batch(){
+
+        for (bool thread_cache_enabled: {false, true}){
+            Arena arena(16u, 4u);
+            Config config               = arena_config(arena);
+            config.thread_cache_enabled = thread_cache_enabled;
+            TLB tlb(config);
+            char * base                 = arena.translator();
+            const void * in[]           = {base + 5u * TEST_PAGE_SZ + 7u, nullptr, base + 3u, base + 5u * TEST_PAGE_SZ + 7u, base + 5u * TEST_PAGE_SZ + 9u, base + 3u, base + 3u, base + 2u * TEST_PAGE_SZ};
+            void * out[std::size(in)]   = {};
+            tlb.map_batch(in, out, std::size(in));
+
+            bool is_intact = out[1] == nullptr;
+
+            for (size_t i = 0; i < std::size(in); ++i){
+                if (in[i]){
+                    size_t offs = static_cast<const char *>(in[i]) - base;
+                    is_intact   = is_intact && *static_cast<char *>(out[i]) == Arena::pattern(offs);
+                }
+            }
+
+            expect(is_intact, "a batch mapped a pointer to the wrong byte");
+            expect(out[0] == out[3] && static_cast<char *>(out[4]) == static_cast<char *>(out[0]) + 2 && out[2] == out[5], "duplicates of a page were mapped apart");
+            expect(device_counter.fill_count == 3u, "a batch filled a page more than once");
+
+            static_cast<char *>(out[7])[0] = 'b';
+            tlb.unmap_batch(in, std::size(in));
+            tlb.flush(); //waits for every reference taken by the batch
+            expect(arena.translator()[2u * TEST_PAGE_SZ] == 'b', "a write through a batch was lost");
+
+            const void * wide_in[5]     = {base, base + TEST_PAGE_SZ, base + 2u * TEST_PAGE_SZ, base + 3u * TEST_PAGE_SZ, base + 4u * TEST_PAGE_SZ};
+            void * wide_out[5]          = {};
+            bool is_thrown              = false;
+
+            try{
+                tlb.map_batch(wide_in, wide_out, 5u);
+            } catch (no_page_found&){
+                is_thrown = true;
+            }
+
+            expect(is_thrown, "a batch wider than the pool was mapped");
+
+            for (size_t page = 8u; page < 12u; ++page){ //the failed batch holds no page
+                tlb.map(base + page * TEST_PAGE_SZ);
+            }
+
+            for (size_t page = 8u; page < 12u; ++page){
+                tlb.unmap(base + page * TEST_PAGE_SZ);
+            }
+        }
+    }
+
+    static inline std::atomic<size_t> write_back_inflight{};
+    static inline std::atomic<size_t> write_back_inflight_max{};
+
+    void concurrent_write_back_device(void * dst, const void * src, size_t sz) noexcept{
+
+        size_t inflight = write_back_inflight.fetch_add(1u) + 1u;
+        size_t max      = write_back_inflight_max.load();
+
+        while (inflight > max && !write_back_inflight_max.compare_exchange_weak(max, inflight)){}
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        write_back_device(dst, src, sz);
+        write_back_inflight.fetch_sub(1u);
+    }
+
+    //a parallel sync/flush writes every dirty page back once with at most max_concurrency transfers in flight
+    //the dirty pages are spread over 4 partitions (WRITE_BACK_PARTITION_SZ) - a partition is written back by one worker
+    void test_parallel_flush(){
+
+        constexpr size_t PAGE_STEP = WRITE_BACK_PARTITION_SZ / 8u;
+
+        Arena arena(4u * WRITE_BACK_PARTITION_SZ, 32u);
+        ThreadPoolExecutor executor(4u);
+        Config config                              = arena_config(arena);
+        config.physical_to_virtual_transfer_device = concurrent_write_back_device;
+        TLB tlb(config);
+
+        for (bool is_flush: {false, true}){
+            for (size_t page = 0; page < 32u; ++page){
+                static_cast<char *>(tlb.map(arena.translator() + page * PAGE_STEP * TEST_PAGE_SZ))[0] = is_flush ? 'f' : 's';
+                tlb.unmap(arena.translator() + page * PAGE_STEP * TEST_PAGE_SZ);
+            }
+
+            device_counter.reset();
+            write_back_inflight_max = 0u;
+
+            if (is_flush){
+                tlb.flush(executor.get(), 3u);
+            } else{
+                tlb.sync(executor.get(), 3u);
+            }
+
+            bool is_intact = true;
+
+            for (size_t page = 0; page < 32u; ++page){
+                is_intact = is_intact && arena.translator()[page * PAGE_STEP * TEST_PAGE_SZ] == (is_flush ? 'f' : 's');
+            }
+
+            expect(is_intact, "a parallel write back lost a page");
+            expect(device_counter.write_back_count == 32u, "a parallel write back did not write each dirty page once");
+            expect(write_back_inflight_max > 1u && write_back_inflight_max <= 3u, "a parallel write back ignored max_concurrency");
+        }
+
+        expect(device_counter.fill_count == 0u, "a synced page was unlinked");
+    }
+
+    //the packed layout keeps every write through eviction, sync and flush - pages across linked bitmap words included
+    void test_packed_layout(){
+
+        for (EvictionPolicy eviction_policy: EVICTION_POLICY_LIST){
+            Arena arena(200u, 16u);
+            Config config            = arena_config(arena, eviction_policy);
+            config.page_table_layout = PageTableLayout::packed;
+            TLB tlb(config);
+            std::vector<char> expected(200u, 0);
+            std::mt19937_64 rng(11u);
+
+            for (size_t i = 0; i < 2048u; ++i){
+                size_t page     = rng() % 200u;
+                char * ptr      = arena.translator() + page * TEST_PAGE_SZ;
+                expected[page]  = static_cast<char>(i | 1u);
+                static_cast<char *>(tlb.map(ptr))[0] = expected[page];
+                tlb.unmap(ptr);
+
+                if (i % 512u == 511u){
+                    tlb.sync();
+                }
+            }
+
+            for (size_t page: {size_t{63u}, size_t{64u}, size_t{127u}, size_t{128u}, size_t{199u}}){
+                static_cast<char *>(tlb.map(arena.translator() + page * TEST_PAGE_SZ))[0] = 'e';
+                expected[page] = 'e';
+                tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+            }
+
+            tlb.flush();
+            bool is_intact = true;
+
+            for (size_t page = 0; page < 200u; ++page){
+                is_intact = is_intact && (expected[page] == 0 || arena.translator()[page * TEST_PAGE_SZ] == expected[page]);
+            }
+
+            expect(is_intact, "a write through the packed layout was lost");
+        }
+    }
+
+    //only linking a page allocates its page table leaf - sync, unmap, shootdown, flush and the eviction scans of untouched leaves allocate nothing
+    void test_lazy_page_table(){
+
+        constexpr size_t PAGE_SZ_SMALL      = 256u;
+        constexpr size_t LEAF_PAGE_COUNT    = VIRTUAL_PAGE_LEAF_BLOCK_COUNT; //padded - one page per state block
+
+        Arena arena(4u * LEAF_PAGE_COUNT, 8u, PAGE_SZ_SMALL);
+        Config config  = arena_config(arena);
+        config.page_sz = PAGE_SZ_SMALL;
+        TLB tlb(config);
+        char * far_ptr = arena.translator() + (3u * LEAF_PAGE_COUNT + 5u) * PAGE_SZ_SMALL;
+
+        tlb.sync(arena.translator() + LEAF_PAGE_COUNT * PAGE_SZ_SMALL);
+        tlb.unmap(arena.translator() + 2u * LEAF_PAGE_COUNT * PAGE_SZ_SMALL); //without a map - a no-op
+        tlb.shootdown(far_ptr);
+        tlb.sync();
+        tlb.flush();
+
+        for (size_t i = 0; i < 256u; ++i){ //eviction within leaf 0 - the CLOCK scan + victim probes of never-linked pages
+            char * ptr = arena.translator() + (i % 64u) * PAGE_SZ_SMALL;
+            static_cast<char *>(tlb.map(ptr))[0] = static_cast<char>(i);
+            tlb.unmap(ptr);
+        }
+
+        #if defined(__DG_TLB_STATS__)
+        expect(tlb.stats().get(Stat::virtual_page_leaf_alloc) == 1u, "a path that does not link allocated a leaf");
+        #endif
+
+        expect(*static_cast<char *>(tlb.map(far_ptr)) == Arena::pattern(3u * LEAF_PAGE_COUNT * PAGE_SZ_SMALL + 5u * PAGE_SZ_SMALL), "a page of a new leaf holds the wrong content");
+        tlb.unmap(far_ptr);
+
+        #if defined(__DG_TLB_STATS__)
+        expect(tlb.stats().get(Stat::virtual_page_leaf_alloc) == 2u, "linking a page of an absent leaf did not allocate it");
+        #endif
+
+        tlb.flush();
+
+        for (size_t i = 192u; i < 256u; ++i){
+            expect(arena.translator()[(i % 64u) * PAGE_SZ_SMALL] == static_cast<char>(i), "a write within the allocated leaf was lost");
+        }
+    }
+
+    //the store as translator over a pool of 4 pages - the reader + writer override the unreachable synchronous devices
+    auto store_config(FileTransferStore& store, char * translatee) -> Config{
+
+        Config config{};
+        config.translator_addr                              = store.translator();
+        config.translator_sz                                = store.translator_sz();
+        config.translatee_addr                              = translatee;
+        config.translatee_sz                                = 4u * TEST_PAGE_SZ;
+        config.virtual_to_physical_transfer_device          = FileTransferStore::unreachable_transfer_device;
+        config.physical_to_virtual_transfer_device          = FileTransferStore::unreachable_transfer_device;
+        config.virtual_to_physical_async_transfer_device    = store.reader();
+        config.physical_to_virtual_async_transfer_device    = store.writer();
+        config.page_sz                                      = TEST_PAGE_SZ;
+
+        return config;
+    }
+
+    //pages stream in from + out to segment files across the segment boundary, holes fill as zero, a later store over the same files reads the writes
+    void test_file_transfer_store(){
+
+        constexpr size_t SEGMENT_PAGE_COUNT = 16u;
+
+        char dir[] = "/tmp/dg_tlb_test_XXXXXX";
+
+        if (!mkdtemp(dir)){
+            expect(false, "mkdtemp failed");
+            return;
+        }
+
+        std::vector<std::string> path_list = {std::string(dir) + "/0", std::string(dir) + "/1"};
+
+        {
+            int fd = open(path_list[0].c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            expect(pwrite(fd, "seed", 4u, 3 * TEST_PAGE_SZ) == 4, "seeding the segment failed");
+            close(fd);
+        }
+
+        for (bool is_direct_io: {false, true}){
+            FileTransferStore store(path_list, SEGMENT_PAGE_COUNT * TEST_PAGE_SZ, TEST_PAGE_SZ, is_direct_io);
+            char * translatee = static_cast<char *>(aligned_alloc(TEST_PAGE_SZ, 4u * TEST_PAGE_SZ));
+
+            {
+                Config config         = store_config(store, translatee);
+                config.dirty_chunk_sz = 512u;
+                TLB tlb(config);
+
+                expect(memcmp(tlb.map_readonly(store.translator() + 3u * TEST_PAGE_SZ), "seed", 4u) == 0, "a seeded page was not read from its segment");
+                tlb.unmap(store.translator() + 3u * TEST_PAGE_SZ);
+                expect(static_cast<char *>(tlb.map_readonly(store.translator() + 20u * TEST_PAGE_SZ))[7] == 0, "a hole did not fill as zero");
+                tlb.unmap(store.translator() + 20u * TEST_PAGE_SZ);
+
+                for (size_t page = 0; page < 2u * SEGMENT_PAGE_COUNT; ++page){ //through a pool of 4 - evicted write backs
+                    char * ptr = store.translator() + page * TEST_PAGE_SZ + 100u;
+                    static_cast<char *>(tlb.map_write(ptr, 1u))[0] = static_cast<char>('a' + page + is_direct_io);
+                    tlb.unmap(ptr);
+                }
+            }
+
+            free(translatee);
+        }
+
+        FileTransferStore store(path_list, SEGMENT_PAGE_COUNT * TEST_PAGE_SZ, TEST_PAGE_SZ);
+        char * translatee = static_cast<char *>(aligned_alloc(TEST_PAGE_SZ, 4u * TEST_PAGE_SZ));
+
+        {
+            TLB tlb(store_config(store, translatee));
+            bool is_intact = true;
+
+            for (size_t page = 0; page < 2u * SEGMENT_PAGE_COUNT; ++page){
+                char * ptr  = store.translator() + page * TEST_PAGE_SZ + 100u;
+                is_intact   = is_intact && *static_cast<char *>(tlb.map_readonly(ptr)) == static_cast<char>('a' + page + 1u);
+                tlb.unmap(ptr);
+            }
+
+            expect(is_intact, "a write back did not reach its segment");
+            expect(memcmp(tlb.map_readonly(store.translator() + 3u * TEST_PAGE_SZ), "seed", 4u) == 0, "a sub-page write back clobbered the rest of the page");
+            tlb.unmap(store.translator() + 3u * TEST_PAGE_SZ);
+        }
+
+        free(translatee);
+
+        for (const auto& path: path_list){
+            unlink(path.c_str());
+        }
+
+        rmdir(dir);
+    }
+
+    //evicted pages are refilled from the victim tier without a device fill, shootdown + flush drop the tier so outside changes are seen
+    void test_victim_tier(){
+
+        Arena arena(16u, 4u);
+        memset(arena.translator(), 0, arena.translator_sz()); //compressible
+        Config config         = arena_config(arena);
+        config.victim_tier_sz = 64u * TEST_PAGE_SZ;
+        TLB tlb(config);
+
+        for (size_t page = 0; page < 8u; ++page){ //pages 0 .. 3 are evicted into the tier
+            char * ptr = arena.translator() + page * TEST_PAGE_SZ;
+            static_cast<char *>(tlb.map(ptr))[10] = static_cast<char>('a' + page);
+            tlb.unmap(ptr);
+        }
+
+        size_t fill_count = device_counter.fill_count;
+        char * ptr        = arena.translator() + TEST_PAGE_SZ;
+        char * mapped     = static_cast<char *>(tlb.map_readonly(ptr));
+
+        expect(mapped[10] == 'b' && mapped[11] == 0, "a page refilled from the victim tier holds the wrong content");
+        expect(device_counter.fill_count == fill_count, "an evicted page was filled from the device instead of the victim tier");
+
+        #if defined(__DG_TLB_STATS__)
+        expect(tlb.stats().get(Stat::victim_tier_hit) == 1u && tlb.stats().get(Stat::victim_tier_insert) >= 4u, "victim tier counters differ from the evictions");
+        #endif
+
+        tlb.unmap(ptr);
+        tlb.shootdown(arena.translator() + 2u * TEST_PAGE_SZ); //page 2 sits in the tier - dropped with it
+        arena.translator()[2u * TEST_PAGE_SZ + 10u] = 'X';
+        expect(static_cast<char *>(tlb.map_readonly(arena.translator() + 2u * TEST_PAGE_SZ))[10] == 'X', "a shot down page was refilled from a stale victim tier entry");
+        tlb.unmap(arena.translator() + 2u * TEST_PAGE_SZ);
+
+        tlb.flush();
+        arena.translator()[3u * TEST_PAGE_SZ + 10u] = 'Y';
+        expect(static_cast<char *>(tlb.map_readonly(arena.translator() + 3u * TEST_PAGE_SZ))[10] == 'Y', "a flushed page was refilled from a stale victim tier entry");
+        tlb.unmap(arena.translator() + 3u * TEST_PAGE_SZ);
+
+        for (size_t page = 4u; page < 8u; ++page){
+            expect(arena.translator()[page * TEST_PAGE_SZ + 10u] == static_cast<char>('a' + page), "a write was lost behind the victim tier");
+        }
+    }
+
+    //concurrent misses on a page in fill share the one transfer - one fill however many threads fault on it
+    void test_miss_coalescing(){
+
+        for (bool thread_cache_enabled: {false, true}){
+            Arena arena(8u, 4u);
+            Config config                              = arena_config(arena);
+            config.virtual_to_physical_transfer_device = slow_fill_device;
+            config.thread_cache_enabled                = thread_cache_enabled;
+            TLB tlb(config);
+            transfer_delay_ms = 20u;
+            std::vector<std::thread> thread_list{};
+            std::atomic<size_t> mismatch_count{};
+
+            for (size_t t = 0; t < 8u; ++t){
+                thread_list.emplace_back([&]{
+                    char * ptr = arena.translator() + 5u * TEST_PAGE_SZ + 9u;
+
+                    if (*static_cast<char *>(tlb.map_readonly(ptr)) != Arena::pattern(5u * TEST_PAGE_SZ + 9u)){
+                        mismatch_count += 1;
+                    }
+
+                    tlb.unmap(ptr);
+                });
+            }
+
+            for (auto& thread: thread_list){
+                thread.join();
+            }
+
+            transfer_delay_ms = 0u;
+            expect(mismatch_count == 0u, "a coalesced miss saw the page before its fill completed");
+            expect(device_counter.fill_count == 1u, "concurrent misses on one page filled it more than once");
+
+            #if defined(__DG_TLB_STATS__)
+            Stats stats = tlb.stats();
+            expect(stats.get(Stat::map_miss) == 1u && stats.get(Stat::map_miss) + stats.get(Stat::link_coalesced) + stats.get(Stat::map_hit) + stats.get(Stat::thread_cache_hit) >= 8u, "coalesced misses were not counted");
+            #endif
+        }
+    }
+
+    //a pool partitioned over 2 nodes hands out every page (the local partition first, then the remote one) + keeps every write
+    void test_numa_partition(){
+
+        constexpr size_t PHYSICAL_PAGE_COUNT = 16u;
+
+        Arena arena(64u, 1u); //translator only - the translatee is the NumaTranslatee
+        NumaTranslatee translatee(PHYSICAL_PAGE_COUNT * TEST_PAGE_SZ, TEST_PAGE_SZ, 2u, HugePagePolicy::transparent);
+
+        expect(translatee.node_count() == 2u && translatee.translatee_sz() == PHYSICAL_PAGE_COUNT * TEST_PAGE_SZ, "the translatee is not split in 2 partitions");
+        expect(reinterpret_cast<uintptr_t>(translatee.translatee()) % HUGE_PAGE_SZ == 0u, "a transparent huge page translatee is not huge page aligned");
+
+        Config config          = arena_config(arena);
+        config.translatee_addr = translatee.translatee();
+        config.translatee_sz   = translatee.translatee_sz();
+        config.numa_node_count = translatee.node_count();
+        TLB tlb(config);
+
+        for (size_t page = 0; page < PHYSICAL_PAGE_COUNT; ++page){ //the calling thread exhausts its node, then takes the other one
+            tlb.map(arena.translator() + page * TEST_PAGE_SZ);
+        }
+
+        for (size_t page = 0; page < PHYSICAL_PAGE_COUNT; ++page){
+            tlb.unmap(arena.translator() + page * TEST_PAGE_SZ);
+        }
+
+        std::vector<std::thread> thread_list{};
+
+        for (size_t t = 0; t < 4u; ++t){
+            thread_list.emplace_back([&, t]{
+                for (size_t i = 0; i < 1024u; ++i){
+                    char * ptr = arena.translator() + ((i * 7u + t) % 64u) * TEST_PAGE_SZ + t;
+                    static_cast<char *>(tlb.map(ptr))[0] = static_cast<char>('a' + t);
+                    tlb.unmap(ptr);
+                }
+            });
+        }
+
+        for (auto& thread: thread_list){
+            thread.join();
+        }
+
+        tlb.flush();
+        bool is_intact = true;
+
+        for (size_t t = 0; t < 4u; ++t){
+            for (size_t page = 0; page < 64u; ++page){
+                is_intact = is_intact && arena.translator()[page * TEST_PAGE_SZ + t] == static_cast<char>('a' + t);
+            }
+        }
+
+        expect(is_intact, "a write through the partitioned pool was lost");
+
+        #if defined(__DG_TLB_STATS__)
+        Stats stats = tlb.stats();
+        expect(stats.numa_acquire_list[0] != 0u && stats.numa_acquire_list[1] != 0u, "a partition was never used");
+        #endif
+    }
+
+    #if defined(__cpp_lib_coroutine)
+
+    static inline std::atomic<bool> gate_is_open{true};
+    static inline std::atomic<size_t> gate_entered_count{}; //gated_fill_device + gated_write_back_device hold the transfer until the gate opens
+
+    void gated_fill_device(void * dst, const void * src, size_t sz) noexcept{
+
+        gate_entered_count += 1;
+
+        while (!gate_is_open){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        fill_device(dst, src, sz);
+    }
+
+    void gated_write_back_device(void * dst, const void * src, size_t sz) noexcept{
+
+        gate_entered_count += 1;
+
+        while (!gate_is_open){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        write_back_device(dst, src, sz);
+    }
+
+    //ThreadPoolExecutor that counts the tasks in progress - a task waiting on a transfer holds its worker
+    class CountingExecutor{
+
+        private:
+
+            struct Task{
+                CountingExecutor * self;
+                executor_task_t task;
+                void * arg;
+            };
+
+            std::atomic<size_t> running_count;
+            ThreadPoolExecutor pool; //joined before running_count is gone
+
+            static void run(void * arg) noexcept{
+
+                auto * task = static_cast<Task *>(arg);
+                task->self->running_count += 1;
+                task->task(task->arg);
+                task->self->running_count -= 1;
+                delete task;
+            }
+
+            static auto post(void * ctx, executor_task_t task, void * arg) noexcept -> bool{
+
+                auto * self         = static_cast<CountingExecutor *>(ctx);
+                auto * counted_task = new (std::nothrow) Task{self, task, arg};
+
+                if (counted_task == nullptr){
+                    return false;
+                }
+
+                Executor executor = self->pool.get();
+
+                if (!executor.post(executor.ctx, &CountingExecutor::run, counted_task)){
+                    delete counted_task;
+                    return false;
+                }
+
+                return true;
+            }
+
+        public:
+
+            explicit CountingExecutor(size_t thread_count): running_count(0u),
+                                                            pool(thread_count){}
+
+            auto get() noexcept -> Executor{
+
+                return Executor{this, &CountingExecutor::post};
+            }
+
+            auto running() const noexcept -> size_t{
+
+                return this->running_count.load();
+            }
+    };
+
+    //refuses every task - a TransferWaiter posted through it is deferred by the publisher
+    auto refuse_post(void *, executor_task_t, void *) noexcept -> bool{
+
+        return false;
+    }
+
+    //starts eagerly + frees its frame on completion - completion is reported through done_count
+    struct DetachedCoroutine{
+        struct promise_type{
+            auto get_return_object() noexcept -> DetachedCoroutine{ return {}; }
+            auto initial_suspend() noexcept -> std::suspend_never{ return {}; }
+            auto final_suspend() noexcept -> std::suspend_never{ return {}; }
+            void return_void() noexcept{}
+            void unhandled_exception() noexcept{ std::abort(); }
+        };
+    };
+
+    auto co_read(TLB& tlb, char * ptr, char expected, Executor executor, std::atomic<size_t>& mismatch_count, std::atomic<size_t>& done_count) -> DetachedCoroutine{
+
+        char * addr = static_cast<char *>(co_await tlb.co_map_readonly(ptr, executor)); //own statement - gcc 12 misplaces the awaitable of a co_await nested in a condition
+
+        if (*addr != expected){
+            mismatch_count += 1;
+        }
+
+        tlb.unmap(ptr);
+        done_count += 1;
+    }
+
+    auto co_write_sync(TLB& tlb, char * ptr, char val, Executor executor, std::atomic<size_t>& done_count) -> DetachedCoroutine{
+
+        char * addr = static_cast<char *>(co_await tlb.co_map(ptr, executor));
+        *addr = val;
+        tlb.unmap(ptr);
+        co_await tlb.co_sync(ptr, executor);
+        done_count += 1;
+    }
+
+    auto co_sync_only(TLB& tlb, char * ptr, Executor executor, std::atomic<size_t>& done_count) -> DetachedCoroutine{
+
+        co_await tlb.co_sync(ptr, executor);
+        done_count += 1;
+    }
+
+    //false if count did not reach n within 5s
+    auto wait_count(const std::atomic<size_t>& count, size_t n) -> bool{
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+        while (count.load() < n){
+            if (std::chrono::steady_clock::now() > deadline){
+                return false;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return true;
+    }
+
+    //co_map of a linked page completes without suspension, coroutines on an in-flight fill or write back wait on the page's waiter list without holding a worker
+    //a waiter whose post is refused is never resumed by the publisher - the next co_map of the TLB resumes it
+    void test_coroutine(){
+
+        constexpr size_t COROUTINE_COUNT = 8u;
+
+        Arena arena(8u, 4u);
+        CountingExecutor executor(COROUTINE_COUNT);
+        Config config                              = arena_config(arena);
+        config.virtual_to_physical_transfer_device = gated_fill_device;
+        config.physical_to_virtual_transfer_device = gated_write_back_device;
+        TLB tlb(config);
+        std::atomic<size_t> mismatch_count{};
+        std::atomic<size_t> done_count{};
+
+        char * hit_ptr = arena.translator() + 7u;
+        tlb.map_readonly(hit_ptr);
+        tlb.unmap(hit_ptr);
+        co_read(tlb, hit_ptr, Arena::pattern(7u), executor.get(), mismatch_count, done_count);
+        expect(done_count == 1u && mismatch_count == 0u, "co_map of a linked page suspended");
+
+        done_count          = 0u;
+        gate_entered_count  = 0u;
+        gate_is_open        = false;
+        char * miss_ptr     = arena.translator() + 3u * TEST_PAGE_SZ + 11u;
+        co_read(tlb, miss_ptr, Arena::pattern(3u * TEST_PAGE_SZ + 11u), executor.get(), mismatch_count, done_count);
+        expect(wait_count(gate_entered_count, 1u), "the fill was not posted");
+
+        for (size_t i = 1; i < COROUTINE_COUNT; ++i){
+            co_read(tlb, miss_ptr, Arena::pattern(3u * TEST_PAGE_SZ + 11u), executor.get(), mismatch_count, done_count);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20)); //any posted wait gets a worker meanwhile
+        expect(executor.running() == 1u, "coroutines waiting on an in-flight fill held workers");
+        gate_is_open = true;
+        expect(wait_count(done_count, COROUTINE_COUNT), "a coroutine waiting on the fill was not resumed");
+        expect(mismatch_count == 0u, "a coroutine saw the page before its fill completed");
+        expect(device_counter.fill_count == 2u, "coroutines on one missing page filled it more than once"); //+ the hit page
+
+        done_count = 0u;
+        char * sync_ptr = arena.translator() + 5u * TEST_PAGE_SZ + 2u;
+        co_write_sync(tlb, sync_ptr, 'w', executor.get(), done_count);
+        expect(wait_count(done_count, 1u), "co_sync did not complete");
+        expect(*sync_ptr == 'w', "co_sync did not write the page back");
+
+        done_count          = 0u;
+        gate_entered_count  = 0u;
+        gate_is_open        = false;
+        static_cast<char *>(tlb.map(sync_ptr))[0] = 'x';
+        tlb.unmap(sync_ptr);
+        std::thread sync_thread([&]{tlb.sync(sync_ptr);});
+        expect(wait_count(gate_entered_count, 1u), "the write back did not start");
+        co_sync_only(tlb, sync_ptr, executor.get(), done_count);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        expect(executor.running() == 0u && done_count == 0u, "co_sync of a page in write back held a worker or did not wait");
+        gate_is_open = true;
+        sync_thread.join();
+        expect(wait_count(done_count, 1u), "co_sync waiting on the write back was not resumed");
+        expect(*sync_ptr == 'x', "the write back awaited by co_sync was lost");
+
+        done_count          = 0u;
+        gate_entered_count  = 0u;
+        gate_is_open        = false;
+        char * refused_ptr  = arena.translator() + 6u * TEST_PAGE_SZ + 4u;
+        Executor refusing_executor{nullptr, &refuse_post};
+        std::thread map_thread([&]{tlb.map_readonly(refused_ptr); tlb.unmap(refused_ptr);});
+        expect(wait_count(gate_entered_count, 1u), "the fill did not start");
+        co_read(tlb, refused_ptr, Arena::pattern(6u * TEST_PAGE_SZ + 4u), refusing_executor, mismatch_count, done_count); //waits on the fill of map_thread
+        gate_is_open = true;
+        map_thread.join();
+        expect(done_count == 0u, "a waiter whose post was refused was resumed by the publishing thread");
+        co_read(tlb, hit_ptr, Arena::pattern(7u), refusing_executor, mismatch_count, done_count); //drains the deferred waiter on this thread
+        expect(done_count == 2u && mismatch_count == 0u, "a deferred waiter was not resumed by the next co_map");
+    }
+
+    #endif
+
+    //keeps the header + every record handed to the sink - write is invoked by one thread per shard at once
+    class MemoryTraceSink{
+
+        private:
+
+            std::mutex mtx;
+            TraceHeader last_header;
+            size_t header_count;
+            std::vector<TraceRecord> record_list;
+
+            static void write_header(void * ctx, const TraceHeader& header) noexcept{
+
+                auto * self = static_cast<MemoryTraceSink *>(ctx);
+                std::lock_guard<std::mutex> lck_grd(self->mtx);
+                self->last_header   = header;
+                self->header_count += 1;
+            }
+
+            static void write_record(void * ctx, const TraceRecord * record_list, size_t record_sz) noexcept{
+
+                auto * self = static_cast<MemoryTraceSink *>(ctx);
+                std::lock_guard<std::mutex> lck_grd(self->mtx);
+                self->record_list.insert(self->record_list.end(), record_list, record_list + record_sz);
+            }
+
+        public:
+
+            MemoryTraceSink(): mtx(),
+                               last_header(),
+                               header_count(0u),
+                               record_list(){}
+
+            auto sink() noexcept -> TraceSink{
+
+                return TraceSink{this, &MemoryTraceSink::write_header, &MemoryTraceSink::write_record};
+            }
+
+            auto header() const noexcept -> const TraceHeader&{
+
+                return this->last_header;
+            }
+
+            auto headers() const noexcept -> size_t{
+
+                return this->header_count;
+            }
+
+            //records in timestamp order - the call order of the tracing thread
+            auto records() const -> std::vector<TraceRecord>{
+
+                std::vector<TraceRecord> rs = this->record_list;
+                std::stable_sort(rs.begin(), rs.end(), [](const TraceRecord& lhs, const TraceRecord& rhs){return lhs.timestamp < rhs.timestamp;});
+                return rs;
+            }
+    };
+
+    //every traced call is one record (op, offset, written bytes) in call order, the header carries the table config, a trace file reads back as written
+    void test_trace(){
+
+        struct ExpectedRecord{
+            TraceOp op;
+            size_t offs;
+            size_t sz;
+        };
+
+        Arena arena(8u, 4u);
+        Config config               = arena_config(arena, EvictionPolicy::clock_cold_insert);
+        config.dirty_chunk_sz       = 512u;
+        config.readahead_page_count = 2u;
+        config.page_table_layout    = PageTableLayout::packed;
+        config.victim_tier_sz       = size_t{1} << 16;
+        config.numa_node_count      = 2u;
+        TLB tlb(config);
+        MemoryTraceSink memory_sink{};
+        tlb.trace_start(memory_sink.sink());
+
+        tlb.map(arena.translator() + 5u);
+        tlb.unmap(arena.translator() + 5u);
+        tlb.map_readonly(arena.translator() + TEST_PAGE_SZ + 7u);
+        tlb.unmap(arena.translator() + TEST_PAGE_SZ + 7u);
+        tlb.map_write(arena.translator() + 2u * TEST_PAGE_SZ + 9u, 3u);
+        tlb.unmap(arena.translator() + 2u * TEST_PAGE_SZ + 9u);
+        tlb.sync(arena.translator() + 2u * TEST_PAGE_SZ);
+        tlb.shootdown(arena.translator() + TEST_PAGE_SZ);
+        tlb.sync();
+        tlb.flush();
+        tlb.trace_stop();
+        tlb.map(arena.translator()); //not traced
+        tlb.unmap(arena.translator());
+
+        const ExpectedRecord EXPECTED_LIST[] = {{TraceOp::map, 5u, TEST_PAGE_SZ}, {TraceOp::unmap, 5u, 0u}, {TraceOp::map_readonly, TEST_PAGE_SZ + 7u, 0u}, {TraceOp::unmap, TEST_PAGE_SZ + 7u, 0u},
+                                                {TraceOp::map, 2u * TEST_PAGE_SZ + 9u, 3u}, {TraceOp::unmap, 2u * TEST_PAGE_SZ + 9u, 0u}, {TraceOp::sync, 2u * TEST_PAGE_SZ, 0u}, {TraceOp::shootdown, TEST_PAGE_SZ, 0u},
+                                                {TraceOp::sync_all, 0u, 0u}, {TraceOp::flush, 0u, 0u}};
+        std::vector<TraceRecord> record_list = memory_sink.records();
+        bool is_matched = record_list.size() == std::size(EXPECTED_LIST);
+
+        for (size_t i = 0; is_matched && i < record_list.size(); ++i){
+            is_matched = record_list[i].op == static_cast<uint8_t>(EXPECTED_LIST[i].op) && record_list[i].offs == EXPECTED_LIST[i].offs && record_list[i].sz == EXPECTED_LIST[i].sz;
+        }
+
+        const TraceHeader& header = memory_sink.header();
+        expect(is_matched, "the trace records do not match the traced calls");
+        expect(memory_sink.headers() == 1u && header.magic == TRACE_MAGIC && header.version == TRACE_VERSION && header.page_sz == TEST_PAGE_SZ && header.translator_sz == arena.translator_sz()
+               && header.translatee_sz == arena.translatee_sz() && header.eviction_policy == static_cast<uint64_t>(EvictionPolicy::clock_cold_insert), "the trace header does not describe the table");
+        expect(header.thread_cache_enabled == 0u && header.dirty_chunk_sz == 512u && header.readahead_page_count == 2u && header.page_table_layout == static_cast<uint64_t>(PageTableLayout::packed)
+               && header.victim_tier_sz == (size_t{1} << 16) && header.numa_node_count == 2u, "the trace header does not carry the engine options");
+
+        char path[] = "/tmp/dg_tlb_trace_XXXXXX";
+        int fd      = mkstemp(path);
+
+        if (fd == -1){
+            expect(false, "mkstemp failed");
+            return;
+        }
+
+        close(fd);
+        constexpr size_t THREAD_COUNT = 2u;
+        constexpr size_t ITER_COUNT   = 64u;
+
+        {
+            TraceFileWriter writer(path);
+            tlb.trace_start(writer.sink());
+            std::vector<std::thread> thread_list{};
+
+            for (size_t t = 0; t < THREAD_COUNT; ++t){
+                thread_list.emplace_back([&, t]{
+                    for (size_t i = 0; i < ITER_COUNT; ++i){
+                        char * ptr = arena.translator() + ((i + t) % 8u) * TEST_PAGE_SZ + t;
+                        tlb.map_readonly(ptr);
+                        tlb.unmap(ptr);
+                    }
+                });
+            }
+
+            for (auto& thread: thread_list){
+                thread.join();
+            }
+
+            tlb.trace_stop();
+        }
+
+        TraceHeader file_header{};
+        std::vector<TraceRecord> file_record_list{};
+        expect(trace_read(path, file_header, file_record_list), "a trace file was not read back");
+        expect(memcmp(&file_header, &header, sizeof(TraceHeader)) == 0, "the trace file header differs from the sink header");
+        expect(file_record_list.size() == THREAD_COUNT * ITER_COUNT * 2u, "the trace file lost records");
+        expect(std::is_sorted(file_record_list.begin(), file_record_list.end(), [](const TraceRecord& lhs, const TraceRecord& rhs){return lhs.timestamp < rhs.timestamp;}), "trace_read did not order the records by timestamp");
+
+        expect(truncate(path, sizeof(TraceHeader) + sizeof(TraceRecord) / 2u) == 0, "truncating the trace file failed");
+        expect(!trace_read(path, file_header, file_record_list), "a truncated trace file was read");
+        unlink(path);
+    }
+
+    struct TestCase{
+        const char * name;
+        void (*fn)();
+    };
+
+    static inline const TestCase TEST_CASE_LIST[] = {
+        {"eviction_round_trip", test_eviction_round_trip},
+        {"no_page_found", test_no_page_found},
+        {"free_list_distinct", test_free_list_distinct},
+        {"map_unmap_shootdown_stress", test_map_unmap_shootdown_stress},
+        {"thread_cache", test_thread_cache},
+        {"independent_instance", test_independent_instance},
+        {"clean_page_no_write_back", test_clean_page_no_write_back},
+        {"partial_dirty_write_back", test_partial_dirty_write_back},
+        {"async_transfer_device", test_async_transfer_device},
+        {"prefetch_readahead", test_prefetch_readahead},
+        {"page_size", test_page_size},
+        {"stats", test_stats},
+        {"slow_transfer_wait", test_slow_transfer_wait},
+        {"reference_overflow", test_reference_overflow},
+        {"unbalanced_unmap", test_unbalanced_unmap},
+        {"page_ref_mapped_range", test_page_ref_mapped_range},
+        {"map_batch", test_map_batch},
+        {"parallel_flush", test_parallel_flush},
+        {"packed_layout", test_packed_layout},
+        {"lazy_page_table", test_lazy_page_table},
+        {"file_transfer_store", test_file_transfer_store},
+        {"victim_tier", test_victim_tier},
+        {"miss_coalescing", test_miss_coalescing},
+        {"numa_partition", test_numa_partition},
+        #if defined(__cpp_lib_coroutine)
+        {"coroutine", test_coroutine},
+        #endif
+        {"trace", test_trace}
+    };
+}
 
 int main(){
-    
-}
\ No newline at end of file
+
+    using namespace test;
+
+    for (const TestCase& test_case: TEST_CASE_LIST){
+        test_name           = test_case.name;
+        size_t prev_count   = failure_count;
+        test_case.fn();
+        printf("%s %s\n", failure_count == prev_count ? "ok  " : "FAIL", test_case.name);
+    }
+
+    return failure_count == 0u ? 0 : 1;
+}